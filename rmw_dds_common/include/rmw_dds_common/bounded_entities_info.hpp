@@ -0,0 +1,61 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_DDS_COMMON__BOUNDED_ENTITIES_INFO_HPP_
+#define RMW_DDS_COMMON__BOUNDED_ENTITIES_INFO_HPP_
+
+#include "rmw_dds_common/visibility_control.h"
+#include "rmw_dds_common/msg/bounded_participant_entities_info.hpp"
+#include "rmw_dds_common/msg/participant_entities_info.hpp"
+
+namespace rmw_dds_common
+{
+
+/// Check if a `ParticipantEntitiesInfo` message fits in a `BoundedParticipantEntitiesInfo`.
+/**
+ * The bounded messages hold up to 4 nodes, with up to 16 data readers and 16 data writers
+ * each, and node names and namespaces of up to 256 characters.
+ */
+RMW_DDS_COMMON_PUBLIC
+bool
+fits_in_bounded_msg(const rmw_dds_common::msg::ParticipantEntitiesInfo & msg);
+
+/// \internal Converts from ParticipantEntitiesInfo to BoundedParticipantEntitiesInfo
+/**
+ * For internal usage, both pointers are assumed to be valid.
+ * `bounded_msg` may be a loaned message, it's fully overwritten.
+ *
+ * \return `true` if converted, `false` if `msg` doesn't fit in the bounded message,
+ *   in which case `bounded_msg` is left unchanged.
+ */
+RMW_DDS_COMMON_PUBLIC
+bool
+convert_to_bounded_msg(
+  const rmw_dds_common::msg::ParticipantEntitiesInfo * msg,
+  rmw_dds_common::msg::BoundedParticipantEntitiesInfo * bounded_msg);
+
+/// \internal Converts from BoundedParticipantEntitiesInfo to ParticipantEntitiesInfo
+/**
+ * For internal usage, both pointers are assumed to be valid.
+ * Counts larger than the capacity of the bounded message are clamped.
+ */
+RMW_DDS_COMMON_PUBLIC
+void
+convert_from_bounded_msg(
+  const rmw_dds_common::msg::BoundedParticipantEntitiesInfo * bounded_msg,
+  rmw_dds_common::msg::ParticipantEntitiesInfo * msg);
+
+}  // namespace rmw_dds_common
+
+#endif  // RMW_DDS_COMMON__BOUNDED_ENTITIES_INFO_HPP_
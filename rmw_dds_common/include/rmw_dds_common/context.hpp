@@ -16,14 +16,20 @@
 #define RMW_DDS_COMMON__CONTEXT_HPP_
 
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <mutex>
+#include <optional>
+#include <random>
 #include <string>
 #include <thread>
 
 #include "rmw/types.h"
 
 #include "rmw_dds_common/graph_cache.hpp"
+#include "rmw_dds_common/local_entity_index.hpp"
+#include "rmw_dds_common/msg/graph_snapshot.hpp"
+#include "rmw_dds_common/msg/graph_snapshot_request.hpp"
 #include "rmw_dds_common/visibility_control.h"
 
 namespace rmw_dds_common
@@ -39,8 +45,27 @@ struct Context
   rmw_publisher_t * pub;
   /// Subscriber used to listen to ParticipantEntitiesInfo discovery data.
   rmw_subscription_t * sub;
+  /// Publisher used to publish ParticipantNodeEntitiesInfo discovery data, one sample per node.
+  /**
+   * If not `nullptr`, every graph update publishes the state of the updated node on it.
+   * ParticipantEntitiesInfo discovery data is then only published if `pub` is not `nullptr`,
+   * e.g. to interoperate with peers that don't subscribe to the per node discovery data.
+   *
+   * The topic is keyed by participant gid, node namespace and node name, so the publisher
+   * should use TRANSIENT_LOCAL durability with KEEP_LAST history of depth 1: a late joiner then
+   * receives the last sample of each node, the `node_removed` one for destroyed nodes.
+   */
+  rmw_publisher_t * node_pub = nullptr;
   /// Cached graph from discovery data.
+  /**
+   * Event loops not using graph_guard_condition can wait on GraphCache::get_change_event_fd().
+   */
   GraphCache graph_cache;
+  /// Index of the data readers and writers of this participant, see LocalEntityIndex.
+  /**
+   * Only entities added with the overloads that take a topic name are indexed.
+   */
+  LocalEntityIndex local_entities;
   /// Thread to listen to discovery data.
   std::thread listener_thread;
   /// Indicates if the listener thread is running.
@@ -55,6 +80,41 @@ struct Context
   /// Publish a graph message when updating or destroying graph cache.
   publish_callback_t publish_callback;
 
+  /// Publisher used to publish BoundedParticipantEntitiesInfo discovery data.
+  /**
+   * If not `nullptr`, and the three loan callbacks are set, ParticipantEntitiesInfo discovery
+   * data is published on it with loaned BoundedParticipantEntitiesInfo messages instead.
+   * If the participant doesn't fit in a BoundedParticipantEntitiesInfo message, a message
+   * can't be borrowed or publishing it fails, ParticipantEntitiesInfo is published on `pub`
+   * as usual, after returning the loan if any.
+   *
+   * Updates may alternate between both topics, late joiners get the last sample of each
+   * topic with no guarantee about which one is newer, so both should be subscribed to and
+   * periodic re-announcements relied on to converge.
+   */
+  rmw_publisher_t * bounded_pub = nullptr;
+
+  using borrow_loaned_message_callback_t =
+    std::function<rmw_ret_t(const rmw_publisher_t * pub, void ** msg)>;
+  /// Borrow a BoundedParticipantEntitiesInfo message, e.g. with rmw_borrow_loaned_message().
+  borrow_loaned_message_callback_t borrow_loaned_message_callback;
+
+  using publish_loaned_message_callback_t =
+    std::function<rmw_ret_t(const rmw_publisher_t * pub, void * msg)>;
+  /// Publish a borrowed message, e.g. with rmw_publish_loaned_message().
+  publish_loaned_message_callback_t publish_loaned_message_callback;
+
+  using return_loaned_message_callback_t =
+    std::function<rmw_ret_t(const rmw_publisher_t * pub, void * msg)>;
+  /// Return a borrowed message that was not published,
+  /// e.g. with rmw_return_loaned_message_from_publisher().
+  return_loaned_message_callback_t return_loaned_message_callback;
+
+  /// Publisher used to publish GraphSnapshotRequest messages, see request_graph_snapshot().
+  rmw_publisher_t * snapshot_request_pub = nullptr;
+  /// Publisher used to publish GraphSnapshot messages, see handle_graph_snapshot_request().
+  rmw_publisher_t * snapshot_pub = nullptr;
+
   /// Add graph for creating a node.
   /**
    * \param name node name.
@@ -92,6 +152,23 @@ struct Context
   add_subscriber_graph(
     const rmw_gid_t & subscription_gid, const std::string & name, const std::string & namespace_);
 
+  /// Add graph for creating a subscription, and add it to the local entities index.
+  /**
+   * \param subscription_gid subscription gid.
+   * \param topic_name DDS topic name of the subscription.
+   * \param type_name DDS type name of the subscription.
+   * \param name node name.
+   * \param namespace_ node namespace.
+   * \return `RMW_RET_OK` if successful, or
+   * \return `RMW_RET_ERROR` an unexpected error occurs.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  rmw_ret_t
+  add_subscriber_graph(
+    const rmw_gid_t & subscription_gid,
+    const std::string & topic_name, const std::string & type_name,
+    const std::string & name, const std::string & namespace_);
+
   /// Remove graph for destroying a subscription.
   /**
    * \param subscription_gid subscription gid.
@@ -118,6 +195,23 @@ struct Context
   add_publisher_graph(
     const rmw_gid_t & publisher_gid, const std::string & name, const std::string & namespace_);
 
+  /// Add graph for creating a publisher, and add it to the local entities index.
+  /**
+   * \param publisher_gid publisher gid.
+   * \param topic_name DDS topic name of the publisher.
+   * \param type_name DDS type name of the publisher.
+   * \param name node name.
+   * \param namespace_ node namespace.
+   * \return `RMW_RET_OK` if successful, or
+   * \return `RMW_RET_ERROR` an unexpected error occurs.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  rmw_ret_t
+  add_publisher_graph(
+    const rmw_gid_t & publisher_gid,
+    const std::string & topic_name, const std::string & type_name,
+    const std::string & name, const std::string & namespace_);
+
   /// Remove graph for destroying a publisher.
   /**
    * \param publisher_gid publisher gid.
@@ -191,11 +285,144 @@ struct Context
     const rmw_gid_t & request_subscriber_gid, const rmw_gid_t & response_publisher_gid,
     const std::string & name, const std::string & namespace_);
 
+  /// Settings of the periodic re-announcement of this participant discovery data.
+  /**
+   * When a remote participant joins, see notify_participant_joined(), a re-announcement is
+   * scheduled after `initial_period`.
+   * While remote participants keep joining, discovery data is republished every period,
+   * doubling the period each time up to `max_period`.
+   * Once a period elapses without participants joining, re-announcements stop and the period
+   * goes back to `initial_period`.
+   * Each period is randomly scaled by a factor in `[1 - jitter, 1 + jitter]`, so that
+   * participants started together don't announce in sync.
+   */
+  struct ReannounceConfig
+  {
+    /// First re-announcement period, zero disables re-announcements.
+    std::chrono::nanoseconds initial_period{0};
+    /// Maximum re-announcement period, not less than `initial_period`.
+    std::chrono::nanoseconds max_period{std::chrono::seconds(30)};
+    /// Relative jitter applied to each period, in the `[0, 1]` range.
+    double jitter = 0.25;
+  };
+
+  /// Set the re-announcement settings, and reset the re-announcement schedule.
+  /**
+   * \param config re-announcement settings.
+   * \return `RMW_RET_OK` if successful, or
+   * \return `RMW_RET_INVALID_ARGUMENT` if `initial_period` is negative or `max_period` is
+   *   less than `initial_period`, the current settings are kept in that case.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  rmw_ret_t
+  set_reannounce_config(const ReannounceConfig & config);
+
+  /// Notify that a remote participant was discovered.
+  /**
+   * \param now current time.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  void
+  notify_participant_joined(std::chrono::steady_clock::time_point now);
+
+  /// Same as above, using the current time.
+  RMW_DDS_COMMON_PUBLIC
+  void
+  notify_participant_joined();
+
+  /// Get the time until the next re-announcement is due.
+  /**
+   * Meant to be used as the wait timeout of the listener thread.
+   *
+   * \param now current time.
+   * \return time until process_reannouncement() should be called, or
+   *   `std::chrono::nanoseconds::max()` if no re-announcement is scheduled.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  std::chrono::nanoseconds
+  time_until_reannouncement(std::chrono::steady_clock::time_point now);
+
+  /// Same as above, using the current time.
+  RMW_DDS_COMMON_PUBLIC
+  std::chrono::nanoseconds
+  time_until_reannouncement();
+
+  /// Republish this participant discovery data if a re-announcement is due.
+  /**
+   * Meant to be called by the listener thread each time it wakes up.
+   *
+   * \param now current time.
+   * \return `RMW_RET_OK` if nothing was due or if successful, or
+   * \return `RMW_RET_ERROR` an unexpected error occurs.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  rmw_ret_t
+  process_reannouncement(std::chrono::steady_clock::time_point now);
+
+  /// Same as above, using the current time.
+  RMW_DDS_COMMON_PUBLIC
+  rmw_ret_t
+  process_reannouncement();
+
+  /// Request a snapshot of the graph known by an already synchronized peer.
+  /**
+   * The peer replies with a GraphSnapshot message, that has to be passed to
+   * handle_graph_snapshot().
+   * Only the reply to the last request is accepted.
+   *
+   * \param peer_gid gid of the participant of the peer.
+   * \return `RMW_RET_OK` if successful, or
+   * \return `RMW_RET_ERROR` an unexpected error occurs.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  rmw_ret_t
+  request_graph_snapshot(const rmw_gid_t & peer_gid);
+
+  /// Reply to a GraphSnapshotRequest message with a snapshot of the graph cache.
+  /**
+   * Requests addressed to other participants are ignored.
+   *
+   * \param request received request.
+   * \return `RMW_RET_OK` if successful or ignored, or
+   * \return `RMW_RET_ERROR` an unexpected error occurs.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  rmw_ret_t
+  handle_graph_snapshot_request(const rmw_dds_common::msg::GraphSnapshotRequest & request);
+
+  /// Load a GraphSnapshot message into the graph cache, see GraphCache::load_snapshot().
+  /**
+   * Snapshots that don't reply to the pending request are ignored.
+   * Loaded entries that are not confirmed by discovery data before `expiry` are removed by
+   * GraphCache::expire_provisional_entries().
+   *
+   * \param snapshot received snapshot.
+   * \param expiry time after which unconfirmed entries are removed.
+   * \return `true` if the graph cache was updated, `false` otherwise.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  handle_graph_snapshot(
+    const rmw_dds_common::msg::GraphSnapshot & snapshot,
+    std::chrono::steady_clock::time_point expiry);
+
 private:
   /// Mutex that should be locked when updating graph cache and publishing a graph message.
   /// Though graph_cache methods are thread safe, both cache update and publishing have to also
   /// be atomic.
   std::mutex node_update_mutex;
+
+  /// Mutex that should be locked when accessing the re-announcement state.
+  std::mutex reannounce_mutex;
+  ReannounceConfig reannounce_config;
+  std::chrono::nanoseconds reannounce_period{0};
+  std::optional<std::chrono::steady_clock::time_point> reannounce_deadline;
+  bool participants_joined = false;
+  std::minstd_rand reannounce_rng;
+
+  /// Mutex that should be locked when accessing the pending snapshot request.
+  std::mutex snapshot_mutex;
+  std::optional<rmw_gid_t> snapshot_peer_gid;
 };
 
 }  // namespace rmw_dds_common
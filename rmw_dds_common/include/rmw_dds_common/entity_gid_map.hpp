@@ -0,0 +1,286 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_DDS_COMMON__ENTITY_GID_MAP_HPP_
+#define RMW_DDS_COMMON__ENTITY_GID_MAP_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "rmw/types.h"
+#include "rosidl_runtime_c/type_hash.h"
+
+#include "rmw_dds_common/gid_utils.hpp"
+#include "rmw_dds_common/visibility_control.h"
+
+namespace rmw_dds_common
+{
+
+/// Generation and time of the last modification of a node, data reader or writer.
+/**
+ * \sa GraphCache::get_changes_since()
+ */
+struct ChangeStamp
+{
+  /// Graph generation of the modification, zero if not stamped.
+  uint64_t generation = 0u;
+  /// Time of the modification.
+  std::chrono::steady_clock::time_point time;
+};
+
+/// Structure to represent the discovery data of an endpoint (data reader or writer).
+struct EntityInfo
+{
+  /// Topic name.
+  std::string topic_name;
+  /// Topic type name.
+  std::string topic_type;
+  /// Topic type hash.
+  rosidl_type_hash_t topic_type_hash;
+  /// Participant gid.
+  /**
+   * Set by `EntityGidMap` when the endpoint is added, it's also the key of its group.
+   */
+  rmw_gid_t participant_gid;
+  /// Quality of service of the topic.
+  rmw_qos_profile_t qos;
+  /// Last modification, only stamped if the GraphCache change index is enabled.
+  ChangeStamp change_stamp;
+
+  /// Simple constructor.
+  EntityInfo(
+    const std::string & topic_name,
+    const std::string & topic_type,
+    const rosidl_type_hash_t & topic_type_hash,
+    const rmw_gid_t & participant_gid,
+    const rmw_qos_profile_t & qos)
+  : topic_name(topic_name),
+    topic_type(topic_type),
+    topic_type_hash(topic_type_hash),
+    participant_gid(participant_gid),
+    qos(qos)
+  {}
+
+  /// Constructor for endpoints whose participant gid is set by `EntityGidMap`.
+  EntityInfo(
+    const std::string & topic_name,
+    const std::string & topic_type,
+    const rosidl_type_hash_t & topic_type_hash,
+    const rmw_qos_profile_t & qos)
+  : EntityInfo(topic_name, topic_type, topic_type_hash, rmw_gid_t{}, qos)
+  {}
+};
+
+/// Map from endpoint gids to endpoints discovery info.
+/**
+ * All the endpoints of a DDS participant share the prefix of the participant gid,
+ * only the last bytes (the entity id) differ.
+ * Endpoints are grouped by gid prefix and participant, and keyed by entity id within a group:
+ * the prefix and the participant gid are stored once per group instead of once per endpoint,
+ * lookups compare a 4 bytes entity id once the group was found, and all the endpoints
+ * of a participant are removed at once.
+ *
+ * Endpoints whose gid prefix doesn't match the participant one are supported,
+ * they just end up in their own group, and removing the endpoints of a participant then
+ * goes through all the groups.
+ *
+ * Iteration order is the gid order when gid prefixes match the participant ones.
+ */
+class EntityGidMap
+{
+public:
+  /// Size of the prefix shared by the gids of a participant and its endpoints.
+  static constexpr size_t prefix_size = 12u;
+  /// Prefix of an endpoint gid.
+  using Prefix = std::array<uint8_t, prefix_size>;
+  /// Remaining part of an endpoint gid, in big endian order to preserve the gid order.
+  using EntityId = uint32_t;
+
+  static_assert(
+    RMW_GID_STORAGE_SIZE == prefix_size + sizeof(EntityId),
+    "gid is expected to be made of a prefix and a 4 bytes entity id");
+
+  /// Key of a group of endpoints.
+  struct GroupKey
+  {
+    /// Gid prefix of the endpoints in the group.
+    Prefix prefix;
+    /// Gid of the participant of the endpoints in the group.
+    rmw_gid_t participant_gid;
+  };
+
+  /// Comparator of group keys, groups with the same prefix are contiguous.
+  struct RMW_DDS_COMMON_PUBLIC_TYPE CompareGroupKey
+  {
+    /// Allow to look up groups by prefix.
+    using is_transparent = void;
+
+    /// Compare lhs with rhs.
+    bool operator()(const GroupKey & lhs, const GroupKey & rhs) const;
+    /// Compare lhs with rhs.
+    bool operator()(const GroupKey & lhs, const Prefix & rhs) const;
+    /// Compare lhs with rhs.
+    bool operator()(const Prefix & lhs, const GroupKey & rhs) const;
+  };
+
+  /// Endpoints of a group, keyed by entity id.
+  using Group = std::map<EntityId, EntityInfo>;
+  /// Groups of endpoints.
+  using Groups = std::map<GroupKey, Group, CompareGroupKey>;
+
+  /// Split a gid in prefix and entity id.
+  RMW_DDS_COMMON_PUBLIC
+  static
+  std::pair<Prefix, EntityId>
+  split_gid(const rmw_gid_t & gid);
+
+  /// Join a prefix and an entity id in a gid.
+  RMW_DDS_COMMON_PUBLIC
+  static
+  rmw_gid_t
+  join_gid(const Prefix & prefix, EntityId entity_id);
+
+  /// Find an endpoint.
+  /**
+   * \param[in] gid gid of the endpoint.
+   * \param[out] participant_gid if not `nullptr` and the endpoint was found,
+   *   set to the gid of the participant of the endpoint.
+   * \return pointer to the endpoint info, `nullptr` if not found.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  EntityInfo *
+  find(const rmw_gid_t & gid, rmw_gid_t * participant_gid = nullptr);
+
+  /// Find an endpoint.
+  /**
+   * \sa find(const rmw_gid_t &, rmw_gid_t *)
+   */
+  RMW_DDS_COMMON_PUBLIC
+  const EntityInfo *
+  find(const rmw_gid_t & gid, rmw_gid_t * participant_gid = nullptr) const;
+
+  /// Count the endpoints with a gid, either 0 or 1.
+  RMW_DDS_COMMON_PUBLIC
+  size_t
+  count(const rmw_gid_t & gid) const;
+
+  /// Add an endpoint, if not present.
+  /**
+   * \param gid gid of the endpoint.
+   * \param participant_gid gid of the participant of the endpoint.
+   * \param info endpoint info.
+   * \return `true` if added, `false` if an endpoint with the same gid was already present.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  emplace(const rmw_gid_t & gid, const rmw_gid_t & participant_gid, EntityInfo info);
+
+  /// Add an endpoint, or replace it if present.
+  /**
+   * The endpoint is moved to another group if the participant changed.
+   *
+   * \param gid gid of the endpoint.
+   * \param participant_gid gid of the participant of the endpoint.
+   * \param info endpoint info.
+   * \return `true` if added, `false` if replaced.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  insert_or_assign(const rmw_gid_t & gid, const rmw_gid_t & participant_gid, EntityInfo info);
+
+  /// Remove an endpoint.
+  /**
+   * \param gid gid of the endpoint.
+   * \return `true` if removed, `false` if not present.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  erase(const rmw_gid_t & gid);
+
+  /// Remove all the endpoints of a participant.
+  /**
+   * \param participant_gid gid of the participant.
+   * \return Number of endpoints removed.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  size_t
+  erase_participant(const rmw_gid_t & participant_gid);
+
+  /// Number of endpoints.
+  size_t
+  size() const
+  {
+    return size_;
+  }
+
+  /// Whether there are no endpoints.
+  bool
+  empty() const
+  {
+    return 0u == size_;
+  }
+
+  /// Call `f(gid, participant_gid, info)` on each endpoint, in order.
+  template<typename FunctorT>
+  void
+  for_each(FunctorT && f) const
+  {
+    for (const auto & group_item : groups_) {
+      const GroupKey & key = group_item.first;
+      for (const auto & item : group_item.second) {
+        f(join_gid(key.prefix, item.first), key.participant_gid, item.second);
+      }
+    }
+  }
+
+  /// \internal Groups of endpoints.
+  /**
+   * Exposed to reallocate the groups in place, adding or removing endpoints through it
+   * leaves `size()` out of sync.
+   */
+  Groups &
+  groups()
+  {
+    return groups_;
+  }
+
+  /// \internal Groups of endpoints.
+  const Groups &
+  groups() const
+  {
+    return groups_;
+  }
+
+private:
+  /// Get or add the group of a participant, counting groups not matching its prefix.
+  Group &
+  emplace_group(const Prefix & prefix, const rmw_gid_t & participant_gid);
+
+  /// Remove a group, counting groups not matching the participant prefix.
+  void
+  erase_group(Groups::iterator it);
+
+  Groups groups_;
+  size_t size_ = 0u;
+  /// Number of groups whose prefix doesn't match the participant gid prefix.
+  size_t mismatched_groups_ = 0u;
+};
+
+}  // namespace rmw_dds_common
+
+#endif  // RMW_DDS_COMMON__ENTITY_GID_MAP_HPP_
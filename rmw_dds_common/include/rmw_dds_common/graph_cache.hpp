@@ -15,9 +15,13 @@
 #ifndef RMW_DDS_COMMON__GRAPH_CACHE_HPP_
 #define RMW_DDS_COMMON__GRAPH_CACHE_HPP_
 
+#include <chrono>
+#include <deque>
 #include <functional>
 #include <map>
 #include <mutex>
+#include <optional>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -30,17 +34,20 @@
 #include "rmw/topic_endpoint_info_array.h"
 #include "rmw/types.h"
 
+#include "rmw_dds_common/entity_gid_map.hpp"
 #include "rmw_dds_common/gid_utils.hpp"
 #include "rmw_dds_common/visibility_control.h"
 #include "rmw_dds_common/msg/gid.hpp"
+#include "rmw_dds_common/msg/bounded_participant_entities_info.hpp"
+#include "rmw_dds_common/msg/graph_snapshot.hpp"
 #include "rmw_dds_common/msg/node_entities_info.hpp"
 #include "rmw_dds_common/msg/participant_entities_info.hpp"
+#include "rmw_dds_common/msg/participant_node_entities_info.hpp"
 
 namespace rmw_dds_common
 {
 
 // Forward-declaration, defined at end of file.
-struct EntityInfo;
 struct ParticipantInfo;
 
 /// Graph cache data structure.
@@ -72,6 +79,427 @@ public:
   void
   clear_on_change_callback();
 
+  /// Destructor, closes the file descriptor returned by get_change_event_fd().
+  RMW_DDS_COMMON_PUBLIC
+  ~GraphCache();
+
+  /// Get the graph generation.
+  /**
+   * The generation is incremented each time the state of the object changes,
+   * i.e. each time the "on change" callback would be called.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  uint64_t
+  get_graph_generation() const;
+
+  /// Get a file descriptor that becomes readable when the graph generation advances.
+  /**
+   * Allows event loops based on `epoll()` or `poll()` to wait for graph changes directly,
+   * without a thread waiting on a guard condition.
+   *
+   * It is a non-blocking Linux eventfd, created on the first call and closed when the object
+   * is destroyed, callers must not close it.
+   * Reading 8 bytes from it returns the number of changes since the previous read,
+   * several changes in between are coalesced in a single wake up.
+   *
+   * \return the file descriptor, or
+   * \return -1 if not supported on this platform or if it could not be created.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  int
+  get_change_event_fd();
+
+  /// Filter applied to discovery data before it is stored in the cache.
+  /**
+   * Discovery data rejected by the filter is never stored nor indexed.
+   * The methods of the local_api are not filtered.
+   */
+  struct IngestFilter
+  {
+    /// If not empty, only data readers and writers whose DDS topic name starts with
+    /// one of these prefixes are stored.
+    std::vector<std::string> topic_name_prefixes;
+    /// If not empty, only nodes whose namespace starts with one of these prefixes are stored,
+    /// together with their data readers and writers.
+    std::vector<std::string> node_namespace_prefixes;
+    /// If not empty, only participants in one of these enclaves are stored,
+    /// together with their nodes, data readers and writers.
+    std::vector<std::string> enclaves;
+    /// If set, data readers and writers of participants that did not send ROS discovery
+    /// information within this period since they were added are dropped.
+    /**
+     * Those participants are considered to be bare DDS applications.
+     * Data readers and writers discovered before the period expires are stored until
+     * prune_bare_dds_participants() is called.
+     * If ROS discovery information arrives later, data readers and writers added from then on
+     * are stored again, but the ones dropped before are not recovered.
+     */
+    std::optional<std::chrono::nanoseconds> bare_dds_participant_grace_period;
+  };
+
+  /// Number of times each ingest filter rejected discovery data.
+  struct IngestFilterStats
+  {
+    /// Data readers and writers rejected because of their topic name.
+    size_t topic_name_hits = 0u;
+    /// Nodes, data readers and writers rejected because of the node namespace.
+    size_t node_namespace_hits = 0u;
+    /// Discovery updates, data readers and writers rejected because of the participant enclave.
+    size_t enclave_hits = 0u;
+    /// Data readers and writers rejected because their participant is a bare DDS application.
+    size_t bare_dds_participant_hits = 0u;
+  };
+
+  /// Set the filter applied to discovery data.
+  /**
+   * The filter is also applied to the participants, nodes, data readers and writers already
+   * in the cache, except for the bare DDS participants filter that is applied by
+   * prune_bare_dds_participants().
+   * Data dropped by a previous filter is not recovered when the filter is relaxed.
+   *
+   * Data readers and writers discovered before their participant are filtered by enclave
+   * when the participant is added.
+   *
+   * \param filter filter to apply.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  void
+  set_ingest_filter(const IngestFilter & filter);
+
+  /// Get the number of times the ingest filter rejected discovery data.
+  RMW_DDS_COMMON_PUBLIC
+  IngestFilterStats
+  get_ingest_filter_stats() const;
+
+  /// Drop data readers and writers of participants whose grace period expired.
+  /**
+   * See IngestFilter::bare_dds_participant_grace_period.
+   * This is expected to be called periodically, e.g. from the discovery listener thread.
+   *
+   * \return `true` if the cache was updated, `false` otherwise.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  prune_bare_dds_participants();
+
+  /// Per participant rate limit applied to `ParticipantEntitiesInfo` updates.
+  /**
+   * Each remote participant has a token bucket that holds up to `burst` tokens and is refilled
+   * at `updates_per_second`.
+   * An update that finds no token is not applied, but kept as the pending update of the
+   * participant, replacing any previous pending update.
+   * Pending updates are applied by flush_pending_participant_updates().
+   */
+  struct UpdateRateLimit
+  {
+    /// Rate at which each participant bucket is refilled, zero disables rate limiting.
+    double updates_per_second = 0.0;
+    /// Maximum number of tokens in each participant bucket, at least 1.
+    /**
+     * Smaller values are clamped to 1, an empty bucket would never let an update through.
+     */
+    size_t burst = 1u;
+  };
+
+  /// Number of `ParticipantEntitiesInfo` updates affected by the rate limit.
+  struct UpdateRateLimitStats
+  {
+    /// Updates that were not applied when received.
+    size_t throttled_updates = 0u;
+    /// Pending updates that were replaced by a newer one before being applied.
+    size_t coalesced_updates = 0u;
+    /// Pending updates that were applied later.
+    size_t flushed_updates = 0u;
+  };
+
+  /// Set the rate limit applied to `ParticipantEntitiesInfo` updates.
+  /**
+   * Disabling the rate limit does not apply pending updates,
+   * flush_pending_participant_updates() must still be called for them.
+   *
+   * \param rate_limit rate limit to apply, a `burst` smaller than 1 is clamped to 1.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  void
+  set_update_rate_limit(const UpdateRateLimit & rate_limit);
+
+  /// Get the number of `ParticipantEntitiesInfo` updates affected by the rate limit.
+  RMW_DDS_COMMON_PUBLIC
+  UpdateRateLimitStats
+  get_update_rate_limit_stats() const;
+
+  /// Set the period during which removals of data readers and writers are held back.
+  /**
+   * A held data reader or writer is still reported by the introspection methods.
+   * If a data reader or writer with the same topic name, type, type hash and QoS profile is
+   * added before the period expires, e.g. because its process restarted, it replaces the held
+   * one.
+   * The on change callback is not called if the gid and participant are the same, and called
+   * once otherwise.
+   * Otherwise, the removal is applied by flush_held_removals().
+   *
+   * Disabling the hysteresis does not apply the held removals,
+   * flush_held_removals() must still be called for them.
+   *
+   * \param period hysteresis period, zero disables it.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  void
+  set_removal_hysteresis(std::chrono::nanoseconds period);
+
+  /// Apply held removals of data readers and writers whose hysteresis period expired.
+  /**
+   * This is expected to be called periodically, e.g. from the discovery listener thread.
+   * The on change callback is called at most once.
+   *
+   * \param now current time.
+   * \return `true` if the cache was updated, `false` otherwise.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  flush_held_removals(std::chrono::steady_clock::time_point now);
+
+  /// Same as above, using the current time.
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  flush_held_removals();
+
+  /// Check if there are removals of data readers or writers being held back.
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  has_held_removals() const;
+
+  /// Memory used by the cache, and effect of compact().
+  struct MemoryStats
+  {
+    /// Number of participants in the cache.
+    size_t participants = 0u;
+    /// Number of nodes in the cache.
+    size_t nodes = 0u;
+    /// Number of data readers and writers in the cache.
+    size_t entities = 0u;
+    /// Estimated bytes used by the cache entries, including unused capacity.
+    size_t estimated_bytes = 0u;
+    /// Number of compaction passes over the whole cache that completed.
+    size_t compaction_passes = 0u;
+    /// Number of entries reallocated by compact().
+    size_t compacted_entries = 0u;
+    /// Estimated bytes of unused capacity released by compact().
+    size_t reclaimed_bytes = 0u;
+    /// Number of times compact() returned free memory to the system.
+    size_t trims = 0u;
+  };
+
+  /// Get the memory used by the cache.
+  RMW_DDS_COMMON_PUBLIC
+  MemoryStats
+  get_memory_stats() const;
+
+  /// Reallocate up to `max_entries` cache entries densely.
+  /**
+   * Each participant, data reader and writer entry is copied into storage of the exact size
+   * and the original is released, which undoes the fragmentation and unused capacity left
+   * by long periods of churn.
+   * Compaction resumes where the previous call stopped, so that it can be run in small steps,
+   * e.g. from the discovery listener thread, without holding the cache for long.
+   * When a pass over the whole cache completes, free memory is returned to the system if
+   * the C library supports it and enough memory was released, see
+   * set_compaction_trim_threshold().
+   * The graph is not modified, and the on change callback is not called.
+   *
+   * \param max_entries maximum number of entries to reallocate, zero does nothing.
+   * \return `true` if a compaction pass completed, `false` otherwise.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  compact(size_t max_entries);
+
+  /// Set how much memory compact() has to release before returning free memory to the system.
+  /**
+   * Returning memory to the system walks the whole heap of the process, so it's only done
+   * at the end of a compaction pass once `bytes` were released since the last time.
+   * Defaults to 1 MiB.
+   *
+   * \param bytes estimated released bytes, zero never returns memory to the system.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  void
+  set_compaction_trim_threshold(size_t bytes);
+
+  /// Sliding window of the discovery churn statistics.
+  /**
+   * The window is made of a fixed number of buckets, the oldest bucket is dropped
+   * as a whole when a new one starts.
+   */
+  struct ChurnWindow
+  {
+    /// Duration of each bucket, zero disables the statistics.
+    std::chrono::nanoseconds bucket_period{0};
+    /// Number of buckets, the window spans `bucket_count * bucket_period`.
+    size_t bucket_count = 1u;
+  };
+
+  /// Discovery churn of a topic within the sliding window.
+  struct TopicChurn
+  {
+    /// Name of the DDS topic.
+    std::string topic_name;
+    /// Data readers and writers added.
+    size_t added = 0u;
+    /// Data readers and writers removed.
+    size_t removed = 0u;
+  };
+
+  /// Discovery churn of a participant within the sliding window.
+  struct ParticipantChurn
+  {
+    /// Gid of the participant.
+    rmw_gid_t participant_gid;
+    /// Times the participant or one of its data readers and writers was added.
+    size_t added = 0u;
+    /// Times the participant or one of its data readers and writers was removed.
+    size_t removed = 0u;
+  };
+
+  /// Set the sliding window of the discovery churn statistics, and reset them.
+  /**
+   * Additions and removals of data readers and writers are counted per topic and per
+   * participant, additions and removals of participants per participant.
+   * Removals held back by the hysteresis are counted when held, and additions folded
+   * into a held removal are counted too: they are churn even if the graph doesn't change.
+   * Changes caused by the ingest filter or by a snapshot are not counted.
+   *
+   * \param window sliding window, a zero bucket period disables the statistics.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  void
+  set_churn_window(const ChurnWindow & window);
+
+  /// Get the topics with the most additions and removals within the sliding window.
+  /**
+   * \param max_count maximum number of topics to return.
+   * \param now current time.
+   * \return Topics sorted by decreasing churn, topics without churn are not included.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  std::vector<TopicChurn>
+  get_top_churn_topics(size_t max_count, std::chrono::steady_clock::time_point now) const;
+
+  /// Same as above, using the current time.
+  RMW_DDS_COMMON_PUBLIC
+  std::vector<TopicChurn>
+  get_top_churn_topics(size_t max_count) const;
+
+  /// Get the participants with the most additions and removals within the sliding window.
+  /**
+   * \param max_count maximum number of participants to return.
+   * \param now current time.
+   * \return Participants sorted by decreasing churn, participants without churn are not
+   *   included.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  std::vector<ParticipantChurn>
+  get_top_churn_participants(
+    size_t max_count,
+    std::chrono::steady_clock::time_point now) const;
+
+  /// Same as above, using the current time.
+  RMW_DDS_COMMON_PUBLIC
+  std::vector<ParticipantChurn>
+  get_top_churn_participants(size_t max_count) const;
+
+  /// Settings of the change index, see get_changes_since().
+  struct ChangeIndexConfig
+  {
+    /// Whether nodes, data readers and writers are stamped and indexed when modified.
+    bool enabled = false;
+    /// Maximum number of removals kept in the index, the oldest ones are dropped first.
+    size_t max_tombstones = 1024u;
+  };
+
+  /// Set the change index settings.
+  /**
+   * Changes made before the index is enabled are not indexed, queries for earlier generations
+   * are truncated.
+   * Disabling the index drops it.
+   *
+   * \param config change index settings.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  void
+  set_change_index_config(const ChangeIndexConfig & config);
+
+  /// Addition, modification or removal of a node, data reader or writer.
+  struct GraphChange
+  {
+    /// Kind of graph entry.
+    enum class Kind
+    {
+      node,
+      data_reader,
+      data_writer,
+    };
+
+    /// Kind of the changed entry.
+    Kind kind;
+    /// Whether the entry was removed, otherwise it was added or modified.
+    bool removed;
+    /// Last modification of the entry.
+    ChangeStamp stamp;
+    /// Gid of the data reader or writer, or gid of the participant of the node.
+    rmw_gid_t gid;
+    /// Topic name of the data reader or writer.
+    std::string topic_name;
+    /// Namespace of the node.
+    std::string node_namespace;
+    /// Name of the node.
+    std::string node_name;
+  };
+
+  /// Result of get_changes_since().
+  struct GraphChanges
+  {
+    /// Changes sorted by generation, only the last one of each entry is reported.
+    /**
+     * An entry that was removed and added again is reported twice, the removal first.
+     */
+    std::vector<GraphChange> changes;
+    /// Current graph generation, to be used in the next query.
+    uint64_t generation = 0u;
+    /// Whether some removals may be missing, either because they were dropped from the index
+    /// or because they happened before it was enabled.
+    /**
+     * If set, the graph should be read again from the introspection methods.
+     */
+    bool truncated = false;
+  };
+
+  /// Get the nodes, data readers and writers changed after a graph generation.
+  /**
+   * Runs in time proportional to the number of changes, instead of the size of the graph.
+   * Data readers and writers added or modified are reported with their current topic name.
+   * If the change index is disabled, no change is reported and the result is truncated.
+   *
+   * \param generation graph generation after which changes are reported,
+   *   e.g. the `GraphChanges::generation` returned by the previous query.
+   * \return Changes with a generation larger than `generation`, and not larger than the
+   *   returned `GraphChanges::generation`.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  GraphChanges
+  get_changes_since(uint64_t generation) const;
+
+  /// Get the nodes, data readers and writers changed after a point in time.
+  /**
+   * \sa get_changes_since(uint64_t) const
+   *
+   * \param time time after which changes are reported.
+   * \return Changes stamped later than `time`.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  GraphChanges
+  get_changes_since(std::chrono::steady_clock::time_point time) const;
+
   /**
    * \defgroup dds_discovery_api dds_discovery_api
    * Methods used to update the Graph Cache based on DDS discovery.
@@ -191,6 +619,8 @@ public:
 
   /// Remove a data writer.
   /**
+   * The removal may be held back, see set_removal_hysteresis().
+   *
    * \param gid GUID of the data writer.
    * \return `true` if the cache was updated,
    *   `false` if the data writer was not present.
@@ -201,6 +631,8 @@ public:
 
   /// Remove a data reader.
   /**
+   * The removal may be held back, see set_removal_hysteresis().
+   *
    * \param gid GUID of the The data reader.
    * \return `true` if the cache was updated,
    *   `false` if the data reader was not present.
@@ -257,12 +689,103 @@ public:
 
   /// Update cached participant info from a `ParticipantEntitiesInfo` message.
   /**
+   * If the participant exceeded its update rate limit, the message is kept as pending
+   * and applied later by flush_pending_participant_updates().
+   *
    * \param msg participant info to update cache from.
    */
   RMW_DDS_COMMON_PUBLIC
   void
   update_participant_entities(const rmw_dds_common::msg::ParticipantEntitiesInfo & msg);
 
+  /// Update cached participant info from a `BoundedParticipantEntitiesInfo` message.
+  /**
+   * Same as above, for the fixed size variant of the message.
+   *
+   * \param msg participant info to update cache from.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  void
+  update_participant_entities(const rmw_dds_common::msg::BoundedParticipantEntitiesInfo & msg);
+
+  /// Apply pending `ParticipantEntitiesInfo` updates of participants that got a new token.
+  /**
+   * This is expected to be called periodically, e.g. from the discovery listener thread.
+   * The on change callback is called at most once.
+   *
+   * \param now current time, used to refill the participant buckets.
+   * \return `true` if the cache was updated, `false` otherwise.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  flush_pending_participant_updates(std::chrono::steady_clock::time_point now);
+
+  /// Same as above, using the current time.
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  flush_pending_participant_updates();
+
+  /// Check if there are `ParticipantEntitiesInfo` updates waiting to be applied.
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  has_pending_participant_updates() const;
+
+  /// Update cached info of a single node from a `ParticipantNodeEntitiesInfo` message.
+  /**
+   * The node is identified by the participant gid, and the node name and namespace.
+   * It's added if it wasn't present, replaced otherwise, or removed if `msg.node_removed`
+   * is `true`.
+   * The other nodes of the participant are not modified.
+   *
+   * These updates are not subject to the update rate limit.
+   *
+   * \param msg node info to update cache from.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  void
+  update_node_entities(const rmw_dds_common::msg::ParticipantNodeEntitiesInfo & msg);
+
+  /// Bulk load a graph snapshot received from a remote participant.
+  /**
+   * Participants, data readers and writers that are not in the cache yet are added as
+   * provisional entries.
+   * A provisional entry is confirmed when it's discovered again, e.g. by add_participant()
+   * or add_entity(), otherwise it's removed by expire_provisional_entries() after `expiry`.
+   * Data readers and writers are still subject to the ingest filter.
+   * The on change callback is called at most once.
+   *
+   * \param snapshot graph snapshot, see get_snapshot().
+   * \param expiry time after which unconfirmed entries are removed.
+   * \return `true` if the cache was updated, `false` otherwise.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  load_snapshot(
+    const rmw_dds_common::msg::GraphSnapshot & snapshot,
+    std::chrono::steady_clock::time_point expiry);
+
+  /// Remove provisional entries loaded from a snapshot that were not confirmed in time.
+  /**
+   * This is expected to be called periodically, e.g. from the discovery listener thread.
+   * The on change callback is called at most once.
+   *
+   * \param now current time.
+   * \return `true` if the cache was updated, `false` otherwise.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  expire_provisional_entries(std::chrono::steady_clock::time_point now);
+
+  /// Same as above, using the current time.
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  expire_provisional_entries();
+
+  /// Check if there are provisional entries loaded from a snapshot.
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  has_provisional_entries() const;
+
   /**
    * @}
    * \defgroup local_api local_api
@@ -445,6 +968,31 @@ public:
     rcutils_allocator_t * allocator,
     rmw_topic_endpoint_info_array_t * endpoints_info) const;
 
+  /// Request to resolve the BEST_AVAILABLE policies of a data reader or writer QoS profile.
+  struct BestAvailableQosRequest
+  {
+    /// Name of the DDS topic.
+    std::string topic_name;
+    /// Whether the profile is for a data reader, resolved against the data writers of the topic,
+    /// otherwise it is resolved against the data readers.
+    bool is_reader;
+    /// QoS profile, its BEST_AVAILABLE policies are resolved in place.
+    rmw_qos_profile_t qos;
+  };
+
+  /// Resolve the BEST_AVAILABLE policies of many QoS profiles at once.
+  /**
+   * Gives the same results as calling qos_profile_get_best_available_for_subscription() or
+   * qos_profile_get_best_available_for_publisher() with the endpoints of each topic,
+   * but the cache is locked and traversed once for all the requests, and no topic endpoint
+   * information array is allocated.
+   *
+   * \param[inout] requests QoS profiles to resolve, in place.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  void
+  resolve_best_available_qos(std::vector<BestAvailableQosRequest> & requests) const;
+
   /// Get all topic names and types.
   /**
    * \param[in] demangle_topic Function to demangle DDS topic names.
@@ -523,6 +1071,26 @@ public:
   size_t
   get_number_of_nodes() const;
 
+  /// Get the discovery data of a participant, as sent to remote participants.
+  /**
+   * \param participant_gid GUID of the participant.
+   * \return Message with the participant nodes, without nodes if the participant is unknown.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  rmw_dds_common::msg::ParticipantEntitiesInfo
+  get_participant_entities_info(const rmw_gid_t & participant_gid) const;
+
+  /// Get a snapshot of the whole graph, to bootstrap the cache of another participant.
+  /**
+   * Held removals are not included.
+   * The requester and responder gids are left zero initialized.
+   *
+   * \return Snapshot of the participants, data readers and writers in the cache.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  rmw_dds_common::msg::GraphSnapshot
+  get_snapshot() const;
+
   /// Get the names, namespaces, and enclaves of all nodes.
   /**
    * \param[inout] node_names A zero initialized string array to be populated with node names.
@@ -556,8 +1124,12 @@ public:
   using NodeEntitiesInfoSeq =
     decltype(std::declval<rmw_dds_common::msg::ParticipantEntitiesInfo>().node_entities_info_seq);
   /// \internal
-  /// Map from endpoint gids to endpoints discovery info.
-  using EntityGidToInfo = std::map<rmw_gid_t, EntityInfo, Compare_rmw_gid_t>;
+  /// Map from endpoint gids to endpoints discovery info, grouped by participant.
+  /**
+   * It used to be a `std::map` keyed by gid, use EntityGidMap::find() and
+   * EntityGidMap::for_each() instead of the map interface.
+   */
+  using EntityGidToInfo = EntityGidMap;
   /// \internal
   /// Map from participant gids to participant discovery info.
   using ParticipantToNodesMap = std::map<rmw_gid_t, ParticipantInfo, Compare_rmw_gid_t>;
@@ -567,10 +1139,233 @@ public:
     decltype(std::declval<rmw_dds_common::msg::NodeEntitiesInfo>().writer_gid_seq);
 
 private:
+  /// Check if a data reader or writer is rejected by the ingest filter.
+  /// Updates the filter stats, `mutex_` must be locked.
+  bool
+  is_entity_filtered_out(
+    const rmw_gid_t & gid,
+    const std::string & topic_name,
+    const rmw_gid_t & participant_gid);
+
+  /// Take a token from the participant bucket, `mutex_` must be locked.
+  bool
+  consume_update_token(ParticipantInfo & info, std::chrono::steady_clock::time_point now);
+
+  /// Hold back the removal of a data reader or writer, `mutex_` must be locked.
+  bool
+  hold_removal(const rmw_gid_t & gid, bool is_reader);
+
+  /// Replace a held data reader or writer with a matching one, `mutex_` must be locked.
+  /**
+   * If the gid changed, the on change callback is called.
+   *
+   * \return `true` if a held removal was folded, `false` otherwise.
+   */
+  bool
+  fold_held_removal(
+    const rmw_gid_t & gid,
+    const std::string & topic_name,
+    const std::string & type_name,
+    const rosidl_type_hash_t & type_hash,
+    const rmw_gid_t & participant_gid,
+    const rmw_qos_profile_t & qos,
+    bool is_reader);
+
+  /// Check if a node is rejected by the ingest filter, `mutex_` must be locked.
+  /**
+   * If rejected, the node data readers and writers are removed and will be rejected
+   * when discovered later.
+   */
+  bool
+  is_node_filtered_out(
+    ParticipantInfo & info,
+    const rmw_dds_common::msg::NodeEntitiesInfo & node_info);
+
+  /// Confirm a data reader or writer loaded from a snapshot, `mutex_` must be locked.
+  /**
+   * \param[out] changed set to whether the discovered entity differs from the snapshot one,
+   *   only if the entity was provisional.
+   * \return `true` if the entity was provisional, `false` otherwise.
+   */
+  bool
+  confirm_provisional_entity(
+    const rmw_gid_t & gid,
+    const std::string & topic_name,
+    const std::string & type_name,
+    const rosidl_type_hash_t & type_hash,
+    const rmw_gid_t & participant_gid,
+    const rmw_qos_profile_t & qos,
+    bool is_reader,
+    bool * changed);
+
+  /// Replace the participant nodes with the ones in `msg`, `mutex_` must be locked.
+  void
+  apply_participant_entities(
+    ParticipantInfo & info,
+    const rmw_dds_common::msg::ParticipantEntitiesInfo & msg);
+
+  /// Advance the graph generation and signal the change event, `mutex_` must be locked.
+  void
+  notify_change();
+
+  /// Count an addition or removal in the churn statistics, `mutex_` must be locked.
+  /**
+   * \param topic_name topic of the data reader or writer, `nullptr` for a participant.
+   * \param participant_gid participant of the data reader or writer, or the participant itself.
+   * \param added whether it's an addition or a removal.
+   */
+  void
+  record_churn(const std::string * topic_name, const rmw_gid_t & participant_gid, bool added);
+
+  /// Count the removal of a data reader or writer in the churn statistics,
+  /// `mutex_` must be locked.
+  void
+  record_entity_removal(const EntityGidToInfo & entities, const rmw_gid_t & gid);
+
+  /// Stamp a data reader or writer in the change index, `mutex_` must be locked.
+  /**
+   * Removals must be indexed before removing the entity from `entities`.
+   * Does nothing if the index is disabled or the entity is not in `entities`.
+   */
+  void
+  index_entity_change(EntityGidToInfo & entities, const rmw_gid_t & gid, bool removed);
+
+  /// Stamp a node in the change index, `mutex_` must be locked.
+  /**
+   * Removals must be indexed before removing the participant from `participants_`.
+   * Does nothing if the index is disabled or the participant is not in `participants_`.
+   */
+  void
+  index_node_change(
+    const rmw_gid_t & participant_gid,
+    const std::string & node_namespace,
+    const std::string & node_name,
+    bool removed);
+
+  /// Stamp the nodes of a participant that differ from `previous_nodes`,
+  /// `mutex_` must be locked.
+  void
+  index_node_changes(
+    const rmw_gid_t & participant_gid,
+    const ParticipantInfo & info,
+    const NodeEntitiesInfoSeq & previous_nodes);
+
+  /// Stamp the removal of all the nodes of a participant, `mutex_` must be locked.
+  void
+  index_participant_removal(const rmw_gid_t & participant_gid);
+
+  /// Remove the data readers and writers of a participant, indexing the removals.
+  /// `mutex_` must be locked.
+  size_t
+  erase_participant_entities(const rmw_gid_t & participant_gid);
+
+  /// Add an entry to the change index, `mutex_` must be locked.
+  /**
+   * \param previous last stamp of the entry, its live entry is removed from the index.
+   * \param change the entry.
+   * \return the new stamp of the entry.
+   */
+  ChangeStamp
+  index_change(const ChangeStamp & previous, GraphChange change);
+
+  /// Drop the oldest removals from the change index, `mutex_` must be locked.
+  void
+  trim_change_index();
+
   EntityGidToInfo data_writers_;
   EntityGidToInfo data_readers_;
   ParticipantToNodesMap participants_;
   std::function<void()> on_change_callback_ = nullptr;
+  uint64_t graph_generation_ = 0u;
+  int change_event_fd_ = -1;
+  IngestFilter ingest_filter_;
+  IngestFilterStats ingest_filter_stats_;
+  UpdateRateLimit update_rate_limit_;
+  UpdateRateLimitStats update_rate_limit_stats_;
+  std::set<rmw_gid_t, Compare_rmw_gid_t> participants_with_pending_update_;
+
+  /// Removal of a data reader or writer held back by the hysteresis.
+  struct HeldRemoval
+  {
+    bool is_reader;
+    std::chrono::steady_clock::time_point deadline;
+  };
+  std::chrono::nanoseconds removal_hysteresis_{0};
+  std::map<rmw_gid_t, HeldRemoval, Compare_rmw_gid_t> held_removals_;
+
+  /// Expiry of the unconfirmed entries loaded from a snapshot.
+  using ProvisionalEntries =
+    std::map<rmw_gid_t, std::chrono::steady_clock::time_point, Compare_rmw_gid_t>;
+  ProvisionalEntries provisional_participants_;
+  ProvisionalEntries provisional_entities_;
+
+  /// Position of the next compact() step.
+  enum class CompactionStage
+  {
+    participants,
+    data_readers,
+    data_writers,
+  };
+  CompactionStage compaction_stage_ = CompactionStage::participants;
+  std::optional<rmw_gid_t> compaction_cursor_;
+  std::optional<EntityGidMap::GroupKey> entity_compaction_cursor_;
+  /// Only the compaction counters are kept, the rest is computed by get_memory_stats().
+  MemoryStats memory_stats_;
+  size_t compaction_trim_threshold_ = 1024u * 1024u;
+  /// Value of `memory_stats_.reclaimed_bytes` when memory was last returned to the system.
+  size_t trimmed_reclaimed_bytes_ = 0u;
+
+  /// Additions and removals counted in a bucket of the churn window.
+  struct ChurnBucket
+  {
+    /// Index of the bucket since the window started, the counts are stale if it's not current.
+    int64_t index = -1;
+    size_t added = 0u;
+    size_t removed = 0u;
+  };
+  /// Ring of `ChurnWindow::bucket_count` buckets.
+  using ChurnBuckets = std::vector<ChurnBucket>;
+  ChurnWindow churn_window_;
+  std::chrono::steady_clock::time_point churn_window_start_;
+  /// Index of the newest bucket, counters without recent churn are dropped when it changes.
+  int64_t churn_newest_index_ = 0;
+  std::map<std::string, ChurnBuckets> topic_churn_;
+  std::map<rmw_gid_t, ChurnBuckets, Compare_rmw_gid_t> participant_churn_;
+
+  /// Orders change stamps by generation, which also orders them by time.
+  struct CompareChangeStamp
+  {
+    using is_transparent = void;
+
+    bool operator()(const ChangeStamp & lhs, const ChangeStamp & rhs) const
+    {
+      return lhs.generation < rhs.generation;
+    }
+    bool operator()(const ChangeStamp & lhs, uint64_t rhs) const
+    {
+      return lhs.generation < rhs;
+    }
+    bool operator()(uint64_t lhs, const ChangeStamp & rhs) const
+    {
+      return lhs < rhs.generation;
+    }
+    bool operator()(const ChangeStamp & lhs, std::chrono::steady_clock::time_point rhs) const
+    {
+      return lhs.time < rhs;
+    }
+    bool operator()(std::chrono::steady_clock::time_point lhs, const ChangeStamp & rhs) const
+    {
+      return lhs < rhs.time;
+    }
+  };
+  /// Last change of each live entry, and removals.
+  using ChangeIndex = std::multimap<ChangeStamp, GraphChange, CompareChangeStamp>;
+  ChangeIndexConfig change_index_config_;
+  ChangeIndex change_index_;
+  /// Removals in the index, oldest first.
+  std::deque<ChangeIndex::iterator> change_index_tombstones_;
+  /// Changes stamped before this may be missing from the index.
+  ChangeStamp change_index_complete_since_;
 
   mutable std::mutex mutex_;
 };
@@ -586,35 +1381,27 @@ struct ParticipantInfo
   GraphCache::NodeEntitiesInfoSeq node_entities_info_seq;
   /// Name of the enclave.
   std::string enclave;
-};
-
-/// Structure to represent the discovery data of an endpoint (data reader or writer).
-struct EntityInfo
-{
-  /// Topic name.
-  std::string topic_name;
-  /// Topic type name.
-  std::string topic_type;
-  /// Topic type hash.
-  rosidl_type_hash_t topic_type_hash;
-  /// Participant gid.
-  rmw_gid_t participant_gid;
-  /// Quality of service of the topic.
-  rmw_qos_profile_t qos;
-
-  /// Simple constructor.
-  EntityInfo(
-    const std::string & topic_name,
-    const std::string & topic_type,
-    const rosidl_type_hash_t & topic_type_hash,
-    const rmw_gid_t & participant_gid,
-    const rmw_qos_profile_t & qos)
-  : topic_name(topic_name),
-    topic_type(topic_type),
-    topic_type_hash(topic_type_hash),
-    participant_gid(participant_gid),
-    qos(qos)
-  {}
+  /// Time at which the participant was added to the cache.
+  std::chrono::steady_clock::time_point discovery_time = std::chrono::steady_clock::now();
+  /// Whether ROS discovery information was received for this participant.
+  bool has_ros_discovery_info = false;
+  /// Whether the participant enclave is rejected by the ingest filter.
+  bool filtered_out = false;
+  /// Whether the participant is a bare DDS application according to the ingest filter.
+  bool is_bare_dds_participant = false;
+  /// Gids of the data readers and writers of nodes rejected by the ingest filter.
+  std::set<rmw_gid_t, Compare_rmw_gid_t> filtered_out_entities;
+  /// Tokens left in the update rate limit bucket.
+  double update_tokens = 0.0;
+  /// Last time the update rate limit bucket was refilled.
+  std::chrono::steady_clock::time_point last_update_refill_time;
+  /// Latest update that was not applied because of the rate limit.
+  std::optional<rmw_dds_common::msg::ParticipantEntitiesInfo> pending_update;
+  /// Last modification of each node, by namespace and name.
+  /**
+   * Only stamped if the change index is enabled.
+   */
+  std::map<std::pair<std::string, std::string>, ChangeStamp> node_change_stamps;
 };
 
 }  // namespace rmw_dds_common
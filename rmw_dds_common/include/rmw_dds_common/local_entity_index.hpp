@@ -0,0 +1,148 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_DDS_COMMON__LOCAL_ENTITY_INDEX_HPP_
+#define RMW_DDS_COMMON__LOCAL_ENTITY_INDEX_HPP_
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rmw/types.h"
+
+#include "rmw_dds_common/gid_utils.hpp"
+#include "rmw_dds_common/visibility_control.h"
+
+namespace rmw_dds_common
+{
+
+/// Data reader or writer created by the local participant.
+struct LocalEntityInfo
+{
+  /// Gid of the data reader or writer.
+  rmw_gid_t gid;
+  /// Name of the DDS topic.
+  std::string topic_name;
+  /// Type name of the DDS topic.
+  std::string type_name;
+  /// Name of the node the entity belongs to.
+  std::string node_name;
+  /// Namespace of the node the entity belongs to.
+  std::string node_namespace;
+  /// Whether the entity is a data reader or a writer.
+  bool is_reader;
+};
+
+/// Index of the data readers and writers created by the local participant.
+/**
+ * It is kept apart from the GraphCache, and guarded by its own mutex, so queries about
+ * the local participant don't contend with remote discovery updates.
+ */
+class LocalEntityIndex
+{
+public:
+  /// Add a data reader or writer.
+  /**
+   * \param info data reader or writer to add.
+   * \return `true` if the index was updated, `false` if the entity was already present.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  add_entity(const LocalEntityInfo & info);
+
+  /// Remove a data reader or writer.
+  /**
+   * \param gid gid of the data reader or writer.
+   * \return `true` if the index was updated, `false` if the entity was not present.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  bool
+  remove_entity(const rmw_gid_t & gid);
+
+  /// Get the number of local data writers for a DDS topic.
+  /**
+   * \param[in] topic_name Name of the DDS topic.
+   * \param[out] count Number of data writers.
+   *
+   * \return RMW_RET_INVALID_ARGUMENT if count is `nullptr`, or
+   * \return RMW_RET_OK.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  rmw_ret_t
+  get_writer_count(
+    const std::string & topic_name,
+    size_t * count) const;
+
+  /// Get the number of local data readers for a DDS topic.
+  /**
+   * \param[in] topic_name Name of the DDS topic.
+   * \param[out] count Number of data readers.
+   *
+   * \return RMW_RET_INVALID_ARGUMENT if count is `nullptr`, or
+   * \return RMW_RET_OK.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  rmw_ret_t
+  get_reader_count(
+    const std::string & topic_name,
+    size_t * count) const;
+
+  /// Get the data writers of a local node.
+  /**
+   * \param node_name Name of the node.
+   * \param node_namespace Namespace of the node.
+   * \return Data writers of the node, sorted by gid.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  std::vector<LocalEntityInfo>
+  get_writers_by_node(
+    const std::string & node_name,
+    const std::string & node_namespace) const;
+
+  /// Get the data readers of a local node.
+  /**
+   * \param node_name Name of the node.
+   * \param node_namespace Namespace of the node.
+   * \return Data readers of the node, sorted by gid.
+   */
+  RMW_DDS_COMMON_PUBLIC
+  std::vector<LocalEntityInfo>
+  get_readers_by_node(
+    const std::string & node_name,
+    const std::string & node_namespace) const;
+
+private:
+  /// Number of data readers and writers of a topic.
+  struct TopicCount
+  {
+    size_t readers = 0u;
+    size_t writers = 0u;
+  };
+
+  std::vector<LocalEntityInfo>
+  get_entities_by_node(
+    const std::string & node_name,
+    const std::string & node_namespace,
+    bool is_reader) const;
+
+  std::map<rmw_gid_t, LocalEntityInfo, Compare_rmw_gid_t> entities_;
+  std::map<std::string, TopicCount> topic_counts_;
+
+  mutable std::mutex mutex_;
+};
+
+}  // namespace rmw_dds_common
+
+#endif  // RMW_DDS_COMMON__LOCAL_ENTITY_INDEX_HPP_
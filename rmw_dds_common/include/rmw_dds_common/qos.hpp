@@ -15,6 +15,7 @@
 #ifndef RMW_DDS_COMMON__QOS_HPP_
 #define RMW_DDS_COMMON__QOS_HPP_
 
+#include <cstdint>
 #include <functional>
 #include <string>
 
@@ -27,6 +28,204 @@
 namespace rmw_dds_common
 {
 
+/// QoS incompatibilities between a publisher and a subscription, as bit flags.
+/**
+ * See qos_profile_get_incompatibilities().
+ */
+enum QoSIncompatibility : uint32_t
+{
+  /// Best effort publisher and reliable subscription.
+  QOS_ERROR_RELIABILITY = 1u << 0u,
+  /// Volatile publisher and transient local subscription.
+  QOS_ERROR_DURABILITY = 1u << 1u,
+  /// Subscription has a deadline, but publisher does not.
+  QOS_ERROR_DEADLINE_MISSING = 1u << 2u,
+  /// Subscription deadline is less than publisher deadline.
+  QOS_ERROR_DEADLINE = 1u << 3u,
+  /// Publisher liveliness is automatic and subscription liveliness is manual by topic.
+  QOS_ERROR_LIVELINESS = 1u << 4u,
+  /// Subscription has a liveliness lease duration, but publisher does not.
+  QOS_ERROR_LEASE_DURATION_MISSING = 1u << 5u,
+  /// Subscription liveliness lease duration is less than publisher one.
+  QOS_ERROR_LEASE_DURATION = 1u << 6u,
+  /// Publisher and subscription reliability are unknown.
+  QOS_WARNING_RELIABILITY_UNKNOWN = 1u << 7u,
+  /// Reliable subscription, but publisher reliability is unknown.
+  QOS_WARNING_PUBLISHER_RELIABILITY_UNKNOWN = 1u << 8u,
+  /// Best effort publisher, but subscription reliability is unknown.
+  QOS_WARNING_SUBSCRIPTION_RELIABILITY_UNKNOWN = 1u << 9u,
+  /// Publisher and subscription durability are unknown.
+  QOS_WARNING_DURABILITY_UNKNOWN = 1u << 10u,
+  /// Transient local subscription, but publisher durability is unknown.
+  QOS_WARNING_PUBLISHER_DURABILITY_UNKNOWN = 1u << 11u,
+  /// Volatile publisher, but subscription durability is unknown.
+  QOS_WARNING_SUBSCRIPTION_DURABILITY_UNKNOWN = 1u << 12u,
+  /// Publisher and subscription liveliness are unknown.
+  QOS_WARNING_LIVELINESS_UNKNOWN = 1u << 13u,
+  /// Subscription liveliness is manual by topic, but publisher liveliness is unknown.
+  QOS_WARNING_PUBLISHER_LIVELINESS_UNKNOWN = 1u << 14u,
+  /// Publisher liveliness is automatic, but subscription liveliness is unknown.
+  QOS_WARNING_SUBSCRIPTION_LIVELINESS_UNKNOWN = 1u << 15u,
+};
+
+/// Mask of the QoSIncompatibility flags that make two QoS profiles incompatible.
+constexpr uint32_t qos_errors_mask = (1u << 7u) - 1u;
+
+/// \internal Compare two rmw_time_t field by field.
+constexpr bool
+qos_time_equal(const rmw_time_t & t1, const rmw_time_t & t2)
+{
+  return t1.sec == t2.sec && t1.nsec == t2.nsec;
+}
+
+/// \internal Compare two rmw_time_t field by field.
+constexpr bool
+qos_time_less(const rmw_time_t & t1, const rmw_time_t & t2)
+{
+  return t1.sec < t2.sec || (t1.sec == t2.sec && t1.nsec < t2.nsec);
+}
+
+/// Get the incompatibilities between a publisher and a subscription QoS profiles.
+/**
+ * This is the core of qos_profile_check_compatible(), usable in constant expressions, e.g. to
+ * check QoS profiles known at compile time with `static_assert`.
+ * Warnings are only reported if there are no errors.
+ *
+ * \param[in] publisher_qos: The QoS profile used for a publisher.
+ * \param[in] subscription_qos: The QoS profile used for a subscription.
+ * \return Bitwise or of the QoSIncompatibility flags found, zero if compatible.
+ */
+constexpr uint32_t
+qos_profile_get_incompatibilities(
+  const rmw_qos_profile_t & publisher_qos,
+  const rmw_qos_profile_t & subscription_qos)
+{
+  constexpr rmw_time_t deadline_default = RMW_QOS_DEADLINE_DEFAULT;
+  constexpr rmw_time_t lease_default = RMW_QOS_LIVELINESS_LEASE_DURATION_DEFAULT;
+  const rmw_time_t & pub_deadline = publisher_qos.deadline;
+  const rmw_time_t & sub_deadline = subscription_qos.deadline;
+  const rmw_time_t & pub_lease = publisher_qos.liveliness_lease_duration;
+  const rmw_time_t & sub_lease = subscription_qos.liveliness_lease_duration;
+  const bool pub_deadline_default = qos_time_equal(pub_deadline, deadline_default);
+  const bool sub_deadline_default = qos_time_equal(sub_deadline, deadline_default);
+  const bool pub_lease_default = qos_time_equal(pub_lease, lease_default);
+  const bool sub_lease_default = qos_time_equal(sub_lease, lease_default);
+
+  uint32_t ret = 0u;
+  if (publisher_qos.reliability == RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT &&
+    subscription_qos.reliability == RMW_QOS_POLICY_RELIABILITY_RELIABLE)
+  {
+    ret |= QOS_ERROR_RELIABILITY;
+  }
+  if (publisher_qos.durability == RMW_QOS_POLICY_DURABILITY_VOLATILE &&
+    subscription_qos.durability == RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL)
+  {
+    ret |= QOS_ERROR_DURABILITY;
+  }
+  if (pub_deadline_default && !sub_deadline_default) {
+    ret |= QOS_ERROR_DEADLINE_MISSING;
+  }
+  if (!pub_deadline_default && !sub_deadline_default &&
+    qos_time_less(sub_deadline, pub_deadline))
+  {
+    ret |= QOS_ERROR_DEADLINE;
+  }
+  if (publisher_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_AUTOMATIC &&
+    subscription_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC)
+  {
+    ret |= QOS_ERROR_LIVELINESS;
+  }
+  if (pub_lease_default && !sub_lease_default) {
+    ret |= QOS_ERROR_LEASE_DURATION_MISSING;
+  }
+  if (!pub_lease_default && !sub_lease_default && qos_time_less(sub_lease, pub_lease)) {
+    ret |= QOS_ERROR_LEASE_DURATION;
+  }
+  if (0u != ret) {
+    return ret;
+  }
+
+  // We don't know the policy if the value is "system default" or "unknown"
+  const bool pub_reliability_unknown =
+    publisher_qos.reliability == RMW_QOS_POLICY_RELIABILITY_SYSTEM_DEFAULT ||
+    publisher_qos.reliability == RMW_QOS_POLICY_RELIABILITY_UNKNOWN;
+  const bool sub_reliability_unknown =
+    subscription_qos.reliability == RMW_QOS_POLICY_RELIABILITY_SYSTEM_DEFAULT ||
+    subscription_qos.reliability == RMW_QOS_POLICY_RELIABILITY_UNKNOWN;
+  const bool pub_durability_unknown =
+    publisher_qos.durability == RMW_QOS_POLICY_DURABILITY_SYSTEM_DEFAULT ||
+    publisher_qos.durability == RMW_QOS_POLICY_DURABILITY_UNKNOWN;
+  const bool sub_durability_unknown =
+    subscription_qos.durability == RMW_QOS_POLICY_DURABILITY_SYSTEM_DEFAULT ||
+    subscription_qos.durability == RMW_QOS_POLICY_DURABILITY_UNKNOWN;
+  const bool pub_liveliness_unknown =
+    publisher_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_SYSTEM_DEFAULT ||
+    publisher_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_UNKNOWN;
+  const bool sub_liveliness_unknown =
+    subscription_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_SYSTEM_DEFAULT ||
+    subscription_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_UNKNOWN;
+
+  if (pub_reliability_unknown && sub_reliability_unknown) {
+    ret |= QOS_WARNING_RELIABILITY_UNKNOWN;
+  } else if (pub_reliability_unknown &&  // NOLINT
+    subscription_qos.reliability == RMW_QOS_POLICY_RELIABILITY_RELIABLE)
+  {
+    ret |= QOS_WARNING_PUBLISHER_RELIABILITY_UNKNOWN;
+  } else if (publisher_qos.reliability == RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT &&  // NOLINT
+    sub_reliability_unknown)
+  {
+    ret |= QOS_WARNING_SUBSCRIPTION_RELIABILITY_UNKNOWN;
+  }
+
+  if (pub_durability_unknown && sub_durability_unknown) {
+    ret |= QOS_WARNING_DURABILITY_UNKNOWN;
+  } else if (pub_durability_unknown &&  // NOLINT
+    subscription_qos.durability == RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL)
+  {
+    ret |= QOS_WARNING_PUBLISHER_DURABILITY_UNKNOWN;
+  } else if (publisher_qos.durability == RMW_QOS_POLICY_DURABILITY_VOLATILE &&  // NOLINT
+    sub_durability_unknown)
+  {
+    ret |= QOS_WARNING_SUBSCRIPTION_DURABILITY_UNKNOWN;
+  }
+
+  if (pub_liveliness_unknown && sub_liveliness_unknown) {
+    ret |= QOS_WARNING_LIVELINESS_UNKNOWN;
+  } else if (pub_liveliness_unknown &&  // NOLINT
+    subscription_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC)
+  {
+    ret |= QOS_WARNING_PUBLISHER_LIVELINESS_UNKNOWN;
+  } else if (publisher_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_AUTOMATIC &&  // NOLINT
+    sub_liveliness_unknown)
+  {
+    ret |= QOS_WARNING_SUBSCRIPTION_LIVELINESS_UNKNOWN;
+  }
+  return ret;
+}
+
+/// Get the compatibility of a publisher and a subscription QoS profiles.
+/**
+ * Same result as qos_profile_check_compatible(), usable in constant expressions.
+ *
+ * \param[in] publisher_qos: The QoS profile used for a publisher.
+ * \param[in] subscription_qos: The QoS profile used for a subscription.
+ * \return `RMW_QOS_COMPATIBILITY_OK` if the QoS profiles are compatible, or
+ * \return `RMW_QOS_COMPATIBILITY_WARNING` if the QoS profiles might be compatible, or
+ * \return `RMW_QOS_COMPATIBILITY_ERROR` if the QoS profiles are not compatible.
+ */
+constexpr rmw_qos_compatibility_type_t
+qos_profile_get_compatibility(
+  const rmw_qos_profile_t & publisher_qos,
+  const rmw_qos_profile_t & subscription_qos)
+{
+  const uint32_t incompatibilities =
+    qos_profile_get_incompatibilities(publisher_qos, subscription_qos);
+  if (0u != (incompatibilities & qos_errors_mask)) {
+    return RMW_QOS_COMPATIBILITY_ERROR;
+  }
+  return 0u != incompatibilities ? RMW_QOS_COMPATIBILITY_WARNING : RMW_QOS_COMPATIBILITY_OK;
+}
+
 /// Check if two QoS profiles are compatible
 /**
  * Two QoS profiles are compatible if a publisher and subcription
@@ -136,6 +335,86 @@ qos_profile_get_best_available_for_publisher(
   const rmw_topic_endpoint_info_array_t * subscriptions_info,
   rmw_qos_profile_t * publisher_profile);
 
+/// Summary of the QoS profiles of the endpoints of a topic.
+/**
+ * Holds what is needed to resolve BEST_AVAILABLE policies against those endpoints,
+ * so that their profiles can be added one at a time with qos_profile_summary_add()
+ * instead of being copied to an endpoint information array.
+ */
+struct QosProfileSummary
+{
+  /// Number of endpoints.
+  size_t count = 0u;
+  /// Number of RELIABLE endpoints.
+  size_t reliable = 0u;
+  /// Number of TRANSIENT_LOCAL endpoints.
+  size_t transient_local = 0u;
+  /// Number of MANUAL_BY_TOPIC endpoints.
+  size_t manual_by_topic = 0u;
+  /// Whether all the endpoints have the default deadline.
+  bool default_deadline = true;
+  /// Largest non default deadline.
+  rmw_time_t largest_deadline = {0u, 0u};
+  /// Smallest non default deadline.
+  rmw_time_t smallest_deadline = RMW_DURATION_INFINITE;
+  /// Whether all the endpoints have the default liveliness lease duration.
+  bool default_liveliness_lease_duration = true;
+  /// Largest non default liveliness lease duration.
+  rmw_time_t largest_liveliness_lease_duration = {0u, 0u};
+  /// Smallest non default liveliness lease duration.
+  rmw_time_t smallest_liveliness_lease_duration = RMW_DURATION_INFINITE;
+};
+
+/// Add the QoS profile of an endpoint to a summary.
+/**
+ * \param[in] profile: QoS profile of the endpoint.
+ * \param[inout] summary: Summary to update.
+ */
+RMW_DDS_COMMON_PUBLIC
+void
+qos_profile_summary_add(const rmw_qos_profile_t & profile, QosProfileSummary & summary);
+
+/// Get the best available QoS policies for a subscription, given a summary of the publishers.
+/**
+ * Same rules as qos_profile_get_best_available_for_subscription().
+ *
+ * \param[in] publishers_summary: Summary of the publishers QoS profiles.
+ * \param[out] subscription_profile: QoS profile that is compatible with the majority of
+ *   the summarized publishers.
+ * \return `RMW_RET_OK` if the operation was successful, or
+ * \return `RMW_RET_INVALID_ARGUMENT` if `subscription_profile` is `nullptr`.
+ */
+RMW_DDS_COMMON_PUBLIC
+rmw_ret_t
+qos_profile_get_best_available_for_subscription(
+  const QosProfileSummary & publishers_summary,
+  rmw_qos_profile_t * subscription_profile);
+
+/// Get the best available QoS policies for a publisher, given a summary of the subscriptions.
+/**
+ * Same rules as qos_profile_get_best_available_for_publisher().
+ *
+ * \param[in] subscriptions_summary: Summary of the subscriptions QoS profiles.
+ * \param[out] publisher_profile: QoS profile that is compatible with the majority of
+ *   the summarized subscriptions.
+ * \return `RMW_RET_OK` if the operation was successful, or
+ * \return `RMW_RET_INVALID_ARGUMENT` if `publisher_profile` is `nullptr`.
+ */
+RMW_DDS_COMMON_PUBLIC
+rmw_ret_t
+qos_profile_get_best_available_for_publisher(
+  const QosProfileSummary & subscriptions_summary,
+  rmw_qos_profile_t * publisher_profile);
+
+/// Check if any policy of a QoS profile is BEST_AVAILABLE.
+/**
+ * \param[in] qos_profile: QoS profile to check.
+ * \return `true` if any policy is BEST_AVAILABLE, `false` otherwise.
+ */
+RMW_DDS_COMMON_PUBLIC
+bool
+qos_profile_has_best_available_policy(const rmw_qos_profile_t & qos_profile);
+
 /// Signature matching rmw_get_publishers_info_by_topic and rmw_get_subscriptions_info_by_topic
 using GetEndpointInfoByTopicFunction = std::function<rmw_ret_t(
       const rmw_node_t *,
@@ -225,6 +504,51 @@ RMW_DDS_COMMON_PUBLIC
 rmw_qos_profile_t
 qos_profile_update_best_available_for_services(const rmw_qos_profile_t & qos_profile);
 
+/// Same policies as `rmw_qos_profile_services_default`, usable in constant expressions.
+constexpr rmw_qos_profile_t qos_profile_services_default_policies =
+{
+  RMW_QOS_POLICY_HISTORY_KEEP_LAST,
+  10,
+  RMW_QOS_POLICY_RELIABILITY_RELIABLE,
+  RMW_QOS_POLICY_DURABILITY_VOLATILE,
+  RMW_QOS_DEADLINE_DEFAULT,
+  RMW_QOS_LIFESPAN_DEFAULT,
+  RMW_QOS_POLICY_LIVELINESS_SYSTEM_DEFAULT,
+  RMW_QOS_LIVELINESS_LEASE_DURATION_DEFAULT,
+  false
+};
+
+/// Same as qos_profile_update_best_available_for_services(), usable in constant expressions.
+/**
+ * \param[in] qos_profile: QoS profile to copy and update.
+ * \return A copy of the input QoS profile with any BEST_AVAILABLE policies overwritten with
+ *   default service policies.
+ */
+constexpr rmw_qos_profile_t
+qos_profile_resolve_best_available_for_services(const rmw_qos_profile_t & qos_profile)
+{
+  constexpr rmw_time_t deadline_best_available = RMW_QOS_DEADLINE_BEST_AVAILABLE;
+  constexpr rmw_time_t lease_best_available = RMW_QOS_LIVELINESS_LEASE_DURATION_BEST_AVAILABLE;
+  const rmw_qos_profile_t & services_default = qos_profile_services_default_policies;
+  rmw_qos_profile_t result = qos_profile;
+  if (RMW_QOS_POLICY_RELIABILITY_BEST_AVAILABLE == result.reliability) {
+    result.reliability = services_default.reliability;
+  }
+  if (RMW_QOS_POLICY_DURABILITY_BEST_AVAILABLE == result.durability) {
+    result.durability = services_default.durability;
+  }
+  if (RMW_QOS_POLICY_LIVELINESS_BEST_AVAILABLE == result.liveliness) {
+    result.liveliness = services_default.liveliness;
+  }
+  if (qos_time_equal(deadline_best_available, result.deadline)) {
+    result.deadline = services_default.deadline;
+  }
+  if (qos_time_equal(lease_best_available, result.liveliness_lease_duration)) {
+    result.liveliness_lease_duration = services_default.liveliness_lease_duration;
+  }
+  return result;
+}
+
 /// Parse USER_DATA "key=value;key=value;"" encoding, finding value of key "typehash"
 /**
  * \param[in] user_data USER_DATA qos raw bytes
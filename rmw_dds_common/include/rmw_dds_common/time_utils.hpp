@@ -15,6 +15,10 @@
 #ifndef RMW_DDS_COMMON__TIME_UTILS_HPP_
 #define RMW_DDS_COMMON__TIME_UTILS_HPP_
 
+#include <cstdint>
+#include <limits>
+
+#include "rmw/time.h"
 #include "rmw/types.h"
 
 #include "rmw_dds_common/visibility_control.h"
@@ -43,6 +47,155 @@ RMW_DDS_COMMON_PUBLIC
 rmw_time_t
 clamp_rmw_time_to_dds_time(const rmw_time_t & time);
 
+/// DDS Duration_t, see DDS v1.4 section 2.3.2.
+/**
+ * Layout compatible with the Duration_t and Time_t types of DDS implementations, that can be
+ * converted field by field.
+ */
+struct DDSDuration
+{
+  int32_t sec;
+  uint32_t nanosec;
+};
+
+/// Infinite DDS Duration_t, see DDS v1.4 section 2.3.2.
+constexpr DDSDuration dds_duration_infinite{0x7FFFFFFF, 0xFFFFFFFFu};
+
+/// Longest finite duration that a DDS Duration_t can represent, in nanoseconds.
+constexpr int64_t dds_duration_max_finite_nanoseconds = 0x7FFFFFFFLL * 1000000000LL + 999999999LL;
+
+/// Convert an rmw_time_t to nanoseconds, saturating at `INT64_MAX`.
+/**
+ * `RMW_DURATION_INFINITE` is converted to `INT64_MAX`.
+ * The nanoseconds field doesn't need to be normalized.
+ */
+constexpr int64_t
+rmw_time_to_nanoseconds(const rmw_time_t & time)
+{
+  constexpr uint64_t max_ns = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+  constexpr uint64_t max_sec = max_ns / 1000000000ULL;
+  if (time.sec > max_sec) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  // Up to `max_sec` seconds and `max_ns` nanoseconds, the sum can't overflow 64 bits.
+  const uint64_t nsec = time.nsec < max_ns ? time.nsec : max_ns;
+  const uint64_t ns = time.sec * 1000000000ULL + nsec;
+  return static_cast<int64_t>(ns < max_ns ? ns : max_ns);
+}
+
+/// Convert nanoseconds to a normalized rmw_time_t, negative values are converted to zero.
+/**
+ * `INT64_MAX` is converted to `RMW_DURATION_INFINITE`.
+ */
+constexpr rmw_time_t
+nanoseconds_to_rmw_time(int64_t nanoseconds)
+{
+  const uint64_t ns = nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds) : 0u;
+  return rmw_time_t{ns / 1000000000ULL, ns % 1000000000ULL};
+}
+
+/// Convert nanoseconds to a DDS Duration_t, negative values are converted to zero.
+/**
+ * `INT64_MAX` is converted to an infinite duration, other durations that are too long for
+ * DDS saturate at `INT_MAX` seconds + (10^9 - 1) nanoseconds, like
+ * clamp_rmw_time_to_dds_time() does.
+ */
+constexpr DDSDuration
+nanoseconds_to_dds_duration(int64_t nanoseconds)
+{
+  if (std::numeric_limits<int64_t>::max() == nanoseconds) {
+    return dds_duration_infinite;
+  }
+  const int64_t ns = nanoseconds < 0 ? 0 :
+    (nanoseconds < dds_duration_max_finite_nanoseconds ?
+    nanoseconds : dds_duration_max_finite_nanoseconds);
+  return DDSDuration{
+    static_cast<int32_t>(ns / 1000000000LL), static_cast<uint32_t>(ns % 1000000000LL)};
+}
+
+/// Convert a DDS Duration_t to nanoseconds, negative durations are converted to zero.
+/**
+ * An infinite duration is converted to `INT64_MAX`.
+ * The nanoseconds field doesn't need to be normalized.
+ */
+constexpr int64_t
+dds_duration_to_nanoseconds(const DDSDuration & duration)
+{
+  if (dds_duration_infinite.sec == duration.sec &&
+    dds_duration_infinite.nanosec == duration.nanosec)
+  {
+    return std::numeric_limits<int64_t>::max();
+  }
+  // Can't overflow, INT_MAX seconds + UINT_MAX nanoseconds fit in 63 bits.
+  const int64_t ns = static_cast<int64_t>(duration.sec) * 1000000000LL + duration.nanosec;
+  return ns > 0 ? ns : 0;
+}
+
+/// Convert an rmw_time_t to a DDS Duration_t.
+/**
+ * Only `RMW_DURATION_INFINITE` is converted to an infinite duration, other durations that are
+ * too long for DDS saturate at `INT_MAX` seconds + (10^9 - 1) nanoseconds, like
+ * clamp_rmw_time_to_dds_time() does.
+ * The nanoseconds field doesn't need to be normalized.
+ */
+constexpr DDSDuration
+rmw_time_to_dds_duration(const rmw_time_t & time)
+{
+  constexpr rmw_time_t infinite = RMW_DURATION_INFINITE;
+  if (infinite.sec == time.sec && infinite.nsec == time.nsec) {
+    return dds_duration_infinite;
+  }
+  const int64_t ns = rmw_time_to_nanoseconds(time);
+  return nanoseconds_to_dds_duration(
+    ns < dds_duration_max_finite_nanoseconds ? ns : dds_duration_max_finite_nanoseconds);
+}
+
+/// Convert a DDS Duration_t to an rmw_time_t, see dds_duration_to_nanoseconds().
+constexpr rmw_time_t
+dds_duration_to_rmw_time(const DDSDuration & duration)
+{
+  return nanoseconds_to_rmw_time(dds_duration_to_nanoseconds(duration));
+}
+
+/// Durations of a QoS profile, converted to DDS Duration_t.
+struct DDSQoSDurations
+{
+  DDSDuration deadline;
+  DDSDuration lifespan;
+  DDSDuration liveliness_lease_duration;
+};
+
+/// Convert all the durations of a QoS profile to DDS Duration_t.
+/**
+ * `RMW_DURATION_UNSPECIFIED` is converted to a zero duration, callers that map it to the
+ * DDS implementation default have to check for it first.
+ * Best available durations have to be resolved first, e.g. with
+ * qos_profile_get_best_available_for_topic_publisher().
+ */
+constexpr DDSQoSDurations
+qos_profile_to_dds_durations(const rmw_qos_profile_t & qos)
+{
+  return DDSQoSDurations{
+    rmw_time_to_dds_duration(qos.deadline),
+    rmw_time_to_dds_duration(qos.lifespan),
+    rmw_time_to_dds_duration(qos.liveliness_lease_duration)};
+}
+
+/// Set all the durations of a QoS profile from DDS Duration_t.
+/**
+ * \param qos QoS profile whose durations are replaced.
+ * \param durations durations to set.
+ * \return the updated QoS profile.
+ */
+constexpr rmw_qos_profile_t
+qos_profile_from_dds_durations(rmw_qos_profile_t qos, const DDSQoSDurations & durations)
+{
+  qos.deadline = dds_duration_to_rmw_time(durations.deadline);
+  qos.lifespan = dds_duration_to_rmw_time(durations.lifespan);
+  qos.liveliness_lease_duration = dds_duration_to_rmw_time(durations.liveliness_lease_duration);
+  return qos;
+}
+
 }  // namespace rmw_dds_common
 
 #endif  // RMW_DDS_COMMON__TIME_UTILS_HPP_
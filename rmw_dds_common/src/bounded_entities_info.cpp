@@ -0,0 +1,142 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_dds_common/bounded_entities_info.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <tuple>
+
+#include "rmw_dds_common/msg/bounded_node_entities_info.hpp"
+#include "rmw_dds_common/msg/bounded_participant_entities_info.hpp"
+#include "rmw_dds_common/msg/node_entities_info.hpp"
+#include "rmw_dds_common/msg/participant_entities_info.hpp"
+
+using BoundedNodeEntitiesInfo = rmw_dds_common::msg::BoundedNodeEntitiesInfo;
+using BoundedParticipantEntitiesInfo = rmw_dds_common::msg::BoundedParticipantEntitiesInfo;
+
+static constexpr size_t max_nodes =
+  std::tuple_size<decltype(BoundedParticipantEntitiesInfo::node_entities_info_seq)>::value;
+static constexpr size_t max_endpoints =
+  std::tuple_size<decltype(BoundedNodeEntitiesInfo::reader_gid_seq)>::value;
+static constexpr size_t max_name_length =
+  std::tuple_size<decltype(BoundedNodeEntitiesInfo::node_name)>::value;
+
+static_assert(
+  max_endpoints == std::tuple_size<decltype(BoundedNodeEntitiesInfo::writer_gid_seq)>::value,
+  "readers and writers arrays must have the same capacity");
+static_assert(
+  max_name_length == std::tuple_size<decltype(BoundedNodeEntitiesInfo::node_namespace)>::value,
+  "node name and namespace arrays must have the same capacity");
+
+template<typename ArrayT>
+static
+void
+__copy_string_to_array(const std::string & str, ArrayT & array)
+{
+  assert(str.size() <= array.size());
+  std::fill(std::copy(str.begin(), str.end(), array.begin()), array.end(), 0);
+}
+
+template<typename ArrayT>
+static
+std::string
+__copy_array_to_string(const ArrayT & array)
+{
+  return std::string(array.begin(), std::find(array.begin(), array.end(), 0));
+}
+
+template<typename GidSeqT, typename GidArrayT>
+static
+uint32_t
+__copy_gids_to_array(const GidSeqT & gids, GidArrayT & array)
+{
+  assert(gids.size() <= array.size());
+  std::fill(
+    std::copy(gids.begin(), gids.end(), array.begin()), array.end(), rmw_dds_common::msg::Gid());
+  return static_cast<uint32_t>(gids.size());
+}
+
+bool
+rmw_dds_common::fits_in_bounded_msg(const rmw_dds_common::msg::ParticipantEntitiesInfo & msg)
+{
+  if (msg.node_entities_info_seq.size() > max_nodes) {
+    return false;
+  }
+  return std::all_of(
+    msg.node_entities_info_seq.begin(),
+    msg.node_entities_info_seq.end(),
+    [](const rmw_dds_common::msg::NodeEntitiesInfo & node_info) {
+      return node_info.node_name.size() <= max_name_length &&
+      node_info.node_namespace.size() <= max_name_length &&
+      node_info.reader_gid_seq.size() <= max_endpoints &&
+      node_info.writer_gid_seq.size() <= max_endpoints;
+    });
+}
+
+bool
+rmw_dds_common::convert_to_bounded_msg(
+  const rmw_dds_common::msg::ParticipantEntitiesInfo * msg,
+  rmw_dds_common::msg::BoundedParticipantEntitiesInfo * bounded_msg)
+{
+  assert(nullptr != msg);
+  assert(nullptr != bounded_msg);
+  if (!fits_in_bounded_msg(*msg)) {
+    return false;
+  }
+  bounded_msg->gid = msg->gid;
+  const auto & nodes = msg->node_entities_info_seq;
+  bounded_msg->node_entities_info_count = static_cast<uint32_t>(nodes.size());
+  for (size_t i = 0; i < max_nodes; i++) {
+    BoundedNodeEntitiesInfo & bounded_node = bounded_msg->node_entities_info_seq[i];
+    if (i >= nodes.size()) {
+      bounded_node = BoundedNodeEntitiesInfo();
+      continue;
+    }
+    __copy_string_to_array(nodes[i].node_namespace, bounded_node.node_namespace);
+    __copy_string_to_array(nodes[i].node_name, bounded_node.node_name);
+    bounded_node.reader_gid_count =
+      __copy_gids_to_array(nodes[i].reader_gid_seq, bounded_node.reader_gid_seq);
+    bounded_node.writer_gid_count =
+      __copy_gids_to_array(nodes[i].writer_gid_seq, bounded_node.writer_gid_seq);
+  }
+  return true;
+}
+
+void
+rmw_dds_common::convert_from_bounded_msg(
+  const rmw_dds_common::msg::BoundedParticipantEntitiesInfo * bounded_msg,
+  rmw_dds_common::msg::ParticipantEntitiesInfo * msg)
+{
+  assert(nullptr != bounded_msg);
+  assert(nullptr != msg);
+  msg->gid = bounded_msg->gid;
+  const size_t node_count = std::min<size_t>(bounded_msg->node_entities_info_count, max_nodes);
+  msg->node_entities_info_seq.resize(node_count);
+  for (size_t i = 0; i < node_count; i++) {
+    const BoundedNodeEntitiesInfo & bounded_node = bounded_msg->node_entities_info_seq[i];
+    rmw_dds_common::msg::NodeEntitiesInfo & node = msg->node_entities_info_seq[i];
+    node.node_namespace = __copy_array_to_string(bounded_node.node_namespace);
+    node.node_name = __copy_array_to_string(bounded_node.node_name);
+    const size_t reader_count = std::min<size_t>(bounded_node.reader_gid_count, max_endpoints);
+    node.reader_gid_seq.assign(
+      bounded_node.reader_gid_seq.begin(),
+      bounded_node.reader_gid_seq.begin() + reader_count);
+    const size_t writer_count = std::min<size_t>(bounded_node.writer_gid_count, max_endpoints);
+    node.writer_gid_seq.assign(
+      bounded_node.writer_gid_seq.begin(),
+      bounded_node.writer_gid_seq.begin() + writer_count);
+  }
+}
@@ -14,12 +14,23 @@
 
 #include "rmw_dds_common/context.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <mutex>
+#include <random>
 #include <string>
 
 #include "rmw/types.h"
 
+#include "rmw_dds_common/bounded_entities_info.hpp"
+#include "rmw_dds_common/gid_utils.hpp"
+#include "rmw_dds_common/msg/bounded_participant_entities_info.hpp"
+#include "rmw_dds_common/msg/gid.hpp"
+#include "rmw_dds_common/msg/graph_snapshot.hpp"
+#include "rmw_dds_common/msg/graph_snapshot_request.hpp"
+#include "rmw_dds_common/msg/node_entities_info.hpp"
 #include "rmw_dds_common/msg/participant_entities_info.hpp"
+#include "rmw_dds_common/msg/participant_node_entities_info.hpp"
 
 namespace rmw_dds_common
 {
@@ -27,16 +38,95 @@ namespace rmw_dds_common
 static bool call_publish_callback(
   const rmw_publisher_t * pub,
   const Context::publish_callback_t & publish_callback,
-  const rmw_dds_common::msg::ParticipantEntitiesInfo & msg)
+  const void * msg)
 {
   if (nullptr == pub || nullptr == publish_callback ||
-    RMW_RET_OK != publish_callback(pub, static_cast<const void *>(&msg)))
+    RMW_RET_OK != publish_callback(pub, msg))
   {
     return false;
   }
   return true;
 }
 
+static rmw_dds_common::msg::ParticipantNodeEntitiesInfo create_node_message(
+  const rmw_dds_common::msg::Gid & gid,
+  const rmw_dds_common::msg::NodeEntitiesInfo & node_info)
+{
+  rmw_dds_common::msg::ParticipantNodeEntitiesInfo node_msg;
+  node_msg.gid = gid;
+  node_msg.node_namespace = node_info.node_namespace;
+  node_msg.node_name = node_info.node_name;
+  node_msg.reader_gid_seq = node_info.reader_gid_seq;
+  node_msg.writer_gid_seq = node_info.writer_gid_seq;
+  node_msg.node_removed = false;
+  return node_msg;
+}
+
+static rmw_dds_common::msg::ParticipantNodeEntitiesInfo create_node_message(
+  const rmw_dds_common::msg::ParticipantEntitiesInfo & msg,
+  const std::string & name, const std::string & namespace_)
+{
+  for (const auto & node_info : msg.node_entities_info_seq) {
+    if (node_info.node_name == name && node_info.node_namespace == namespace_) {
+      return create_node_message(msg.gid, node_info);
+    }
+  }
+  rmw_dds_common::msg::ParticipantNodeEntitiesInfo node_msg;
+  node_msg.gid = msg.gid;
+  node_msg.node_namespace = namespace_;
+  node_msg.node_name = name;
+  node_msg.node_removed = true;
+  return node_msg;
+}
+
+static bool publish_participant_message(
+  const Context & context,
+  const rmw_dds_common::msg::ParticipantEntitiesInfo & msg)
+{
+  if (nullptr != context.bounded_pub &&
+    nullptr != context.borrow_loaned_message_callback &&
+    nullptr != context.publish_loaned_message_callback &&
+    nullptr != context.return_loaned_message_callback &&
+    fits_in_bounded_msg(msg))
+  {
+    void * loaned_msg = nullptr;
+    if (RMW_RET_OK == context.borrow_loaned_message_callback(context.bounded_pub, &loaned_msg) &&
+      nullptr != loaned_msg)
+    {
+      auto bounded_msg = static_cast<rmw_dds_common::msg::BoundedParticipantEntitiesInfo *>(
+        loaned_msg);
+      if (
+        convert_to_bounded_msg(&msg, bounded_msg) &&
+        RMW_RET_OK == context.publish_loaned_message_callback(context.bounded_pub, loaned_msg))
+      {
+        return true;
+      }
+      // The loan is still ours if it wasn't published, return it before falling back to `pub`.
+      if (RMW_RET_OK != context.return_loaned_message_callback(context.bounded_pub, loaned_msg)) {
+        return false;
+      }
+    }
+  }
+  return call_publish_callback(context.pub, context.publish_callback, &msg);
+}
+
+static bool publish_graph_update(
+  const Context & context,
+  const rmw_dds_common::msg::ParticipantEntitiesInfo & msg,
+  const std::string & name, const std::string & namespace_)
+{
+  if (nullptr == context.node_pub) {
+    return publish_participant_message(context, msg);
+  }
+  rmw_dds_common::msg::ParticipantNodeEntitiesInfo node_msg =
+    create_node_message(msg, name, namespace_);
+  if (!call_publish_callback(context.node_pub, context.publish_callback, &node_msg)) {
+    return false;
+  }
+  return (nullptr == context.pub && nullptr == context.bounded_pub) ||
+         publish_participant_message(context, msg);
+}
+
 rmw_ret_t Context::add_node_graph(
   const std::string & name, const std::string & namespace_)
 {
@@ -44,7 +134,7 @@ rmw_ret_t Context::add_node_graph(
   rmw_dds_common::msg::ParticipantEntitiesInfo msg =
     graph_cache.add_node(gid, name, namespace_);
 
-  if (!call_publish_callback(pub, publish_callback, msg)) {
+  if (!publish_graph_update(*this, msg, name, namespace_)) {
     graph_cache.remove_node(gid, name, namespace_);
     return RMW_RET_ERROR;
   }
@@ -59,7 +149,7 @@ rmw_ret_t Context::remove_node_graph(
   rmw_dds_common::msg::ParticipantEntitiesInfo msg =
     graph_cache.remove_node(gid, name, namespace_);
 
-  if (!call_publish_callback(pub, publish_callback, msg)) {
+  if (!publish_graph_update(*this, msg, name, namespace_)) {
     return RMW_RET_ERROR;
   }
 
@@ -74,7 +164,7 @@ rmw_ret_t Context::add_subscriber_graph(
     graph_cache.associate_reader(
     subscription_gid, gid, name, namespace_);
 
-  if (!call_publish_callback(pub, publish_callback, msg)) {
+  if (!publish_graph_update(*this, msg, name, namespace_)) {
     static_cast<void>(graph_cache.dissociate_reader(
       subscription_gid, gid, name, namespace_));
     return RMW_RET_ERROR;
@@ -83,6 +173,18 @@ rmw_ret_t Context::add_subscriber_graph(
   return RMW_RET_OK;
 }
 
+rmw_ret_t Context::add_subscriber_graph(
+  const rmw_gid_t & subscription_gid,
+  const std::string & topic_name, const std::string & type_name,
+  const std::string & name, const std::string & namespace_)
+{
+  rmw_ret_t ret = add_subscriber_graph(subscription_gid, name, namespace_);
+  if (RMW_RET_OK == ret) {
+    local_entities.add_entity({subscription_gid, topic_name, type_name, name, namespace_, true});
+  }
+  return ret;
+}
+
 rmw_ret_t Context::remove_subscriber_graph(
   const rmw_gid_t & subscription_gid, const std::string & name, const std::string & namespace_)
 {
@@ -90,8 +192,9 @@ rmw_ret_t Context::remove_subscriber_graph(
   rmw_dds_common::msg::ParticipantEntitiesInfo msg =
     graph_cache.dissociate_reader(
     subscription_gid, gid, name, namespace_);
+  local_entities.remove_entity(subscription_gid);
 
-  if (!call_publish_callback(pub, publish_callback, msg)) {
+  if (!publish_graph_update(*this, msg, name, namespace_)) {
     return RMW_RET_ERROR;
   }
 
@@ -106,7 +209,7 @@ rmw_ret_t Context::add_publisher_graph(
     graph_cache.associate_writer(
     publisher_gid, gid, name, namespace_);
 
-  if (!call_publish_callback(pub, publish_callback, msg)) {
+  if (!publish_graph_update(*this, msg, name, namespace_)) {
     static_cast<void>(graph_cache.dissociate_writer(
       publisher_gid, gid, name, namespace_));
     return RMW_RET_ERROR;
@@ -115,6 +218,18 @@ rmw_ret_t Context::add_publisher_graph(
   return RMW_RET_OK;
 }
 
+rmw_ret_t Context::add_publisher_graph(
+  const rmw_gid_t & publisher_gid,
+  const std::string & topic_name, const std::string & type_name,
+  const std::string & name, const std::string & namespace_)
+{
+  rmw_ret_t ret = add_publisher_graph(publisher_gid, name, namespace_);
+  if (RMW_RET_OK == ret) {
+    local_entities.add_entity({publisher_gid, topic_name, type_name, name, namespace_, false});
+  }
+  return ret;
+}
+
 rmw_ret_t Context::remove_publisher_graph(
   const rmw_gid_t & publisher_gid, const std::string & name, const std::string & namespace_)
 {
@@ -122,8 +237,9 @@ rmw_ret_t Context::remove_publisher_graph(
   rmw_dds_common::msg::ParticipantEntitiesInfo msg =
     graph_cache.dissociate_writer(
     publisher_gid, gid, name, namespace_);
+  local_entities.remove_entity(publisher_gid);
 
-  if (!call_publish_callback(pub, publish_callback, msg)) {
+  if (!publish_graph_update(*this, msg, name, namespace_)) {
     return RMW_RET_ERROR;
   }
 
@@ -142,7 +258,7 @@ rmw_ret_t Context::add_client_graph(
     graph_cache.associate_reader(
     response_subscriber_gid, gid, name, namespace_);
 
-  if (!call_publish_callback(pub, publish_callback, msg)) {
+  if (!publish_graph_update(*this, msg, name, namespace_)) {
     static_cast<void>(graph_cache.dissociate_reader(
       response_subscriber_gid, gid, name, namespace_));
     static_cast<void>(graph_cache.dissociate_writer(
@@ -165,7 +281,7 @@ rmw_ret_t Context::remove_client_graph(
     graph_cache.dissociate_reader(
     response_subscriber_gid, gid, name, namespace_);
 
-  if (!call_publish_callback(pub, publish_callback, msg)) {
+  if (!publish_graph_update(*this, msg, name, namespace_)) {
     return RMW_RET_ERROR;
   }
 
@@ -184,7 +300,7 @@ rmw_ret_t Context::add_service_graph(
     graph_cache.associate_writer(
     response_publisher_gid, gid, name, namespace_);
 
-  if (!call_publish_callback(pub, publish_callback, msg)) {
+  if (!publish_graph_update(*this, msg, name, namespace_)) {
     static_cast<void>(graph_cache.dissociate_writer(
       response_publisher_gid, gid, name, namespace_));
     static_cast<void>(graph_cache.dissociate_reader(
@@ -207,11 +323,177 @@ rmw_ret_t Context::remove_service_graph(
     graph_cache.dissociate_writer(
     response_publisher_gid, gid, name, namespace_);
 
-  if (!call_publish_callback(pub, publish_callback, msg)) {
+  if (!publish_graph_update(*this, msg, name, namespace_)) {
+    return RMW_RET_ERROR;
+  }
+
+  return RMW_RET_OK;
+}
+
+rmw_ret_t Context::set_reannounce_config(const ReannounceConfig & config)
+{
+  if (config.initial_period.count() < 0 || config.max_period < config.initial_period) {
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> guard(reannounce_mutex);
+  reannounce_config = config;
+  reannounce_config.jitter = std::clamp(reannounce_config.jitter, 0.0, 1.0);
+  reannounce_period = reannounce_config.initial_period;
+  reannounce_deadline.reset();
+  participants_joined = false;
+  // Participants started together must not share a seed.
+  std::seed_seq seed{
+    static_cast<uint32_t>(std::random_device{}()),
+    static_cast<uint32_t>(gid.data[RMW_GID_STORAGE_SIZE - 1]),
+    static_cast<uint32_t>(gid.data[RMW_GID_STORAGE_SIZE - 2])};
+  reannounce_rng.seed(seed);
+  return RMW_RET_OK;
+}
+
+static std::chrono::nanoseconds apply_jitter(
+  std::chrono::nanoseconds period, double jitter, std::minstd_rand & rng)
+{
+  if (0.0 == jitter) {
+    return period;
+  }
+  std::uniform_real_distribution<double> distribution(1.0 - jitter, 1.0 + jitter);
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(period * distribution(rng));
+}
+
+void Context::notify_participant_joined(std::chrono::steady_clock::time_point now)
+{
+  std::lock_guard<std::mutex> guard(reannounce_mutex);
+  if (0 == reannounce_config.initial_period.count()) {
+    return;
+  }
+  participants_joined = true;
+  if (!reannounce_deadline) {
+    reannounce_deadline =
+      now + apply_jitter(reannounce_period, reannounce_config.jitter, reannounce_rng);
+  }
+}
+
+void Context::notify_participant_joined()
+{
+  notify_participant_joined(std::chrono::steady_clock::now());
+}
+
+std::chrono::nanoseconds Context::time_until_reannouncement(
+  std::chrono::steady_clock::time_point now)
+{
+  std::lock_guard<std::mutex> guard(reannounce_mutex);
+  if (!reannounce_deadline) {
+    return std::chrono::nanoseconds::max();
+  }
+  if (*reannounce_deadline <= now) {
+    return std::chrono::nanoseconds(0);
+  }
+  return *reannounce_deadline - now;
+}
+
+std::chrono::nanoseconds Context::time_until_reannouncement()
+{
+  return time_until_reannouncement(std::chrono::steady_clock::now());
+}
+
+rmw_ret_t Context::process_reannouncement(std::chrono::steady_clock::time_point now)
+{
+  {
+    std::lock_guard<std::mutex> guard(reannounce_mutex);
+    if (!reannounce_deadline || now < *reannounce_deadline) {
+      return RMW_RET_OK;
+    }
+    if (!participants_joined) {
+      // Quiet period, stop until a new participant joins.
+      reannounce_period = reannounce_config.initial_period;
+      reannounce_deadline.reset();
+      return RMW_RET_OK;
+    }
+    participants_joined = false;
+    // Saturate instead of doubling, which could overflow with large periods.
+    reannounce_period = reannounce_period >= reannounce_config.max_period / 2 ?
+      reannounce_config.max_period : 2 * reannounce_period;
+    reannounce_deadline =
+      now + apply_jitter(reannounce_period, reannounce_config.jitter, reannounce_rng);
+  }
+
+  std::lock_guard<std::mutex> guard(node_update_mutex);
+  rmw_dds_common::msg::ParticipantEntitiesInfo msg =
+    graph_cache.get_participant_entities_info(gid);
+  if (nullptr != node_pub) {
+    for (const auto & node_info : msg.node_entities_info_seq) {
+      rmw_dds_common::msg::ParticipantNodeEntitiesInfo node_msg =
+        create_node_message(msg.gid, node_info);
+      if (!call_publish_callback(node_pub, publish_callback, &node_msg)) {
+        return RMW_RET_ERROR;
+      }
+    }
+    if (nullptr == pub && nullptr == bounded_pub) {
+      return RMW_RET_OK;
+    }
+  }
+  if (!publish_participant_message(*this, msg)) {
     return RMW_RET_ERROR;
   }
+  return RMW_RET_OK;
+}
+
+rmw_ret_t Context::process_reannouncement()
+{
+  return process_reannouncement(std::chrono::steady_clock::now());
+}
 
+rmw_ret_t Context::request_graph_snapshot(const rmw_gid_t & peer_gid)
+{
+  rmw_dds_common::msg::GraphSnapshotRequest request;
+  convert_gid_to_msg(&gid, &request.requester_gid);
+  convert_gid_to_msg(&peer_gid, &request.responder_gid);
+  {
+    // Set before publishing, the reply may be received before publishing returns.
+    std::lock_guard<std::mutex> guard(snapshot_mutex);
+    snapshot_peer_gid = peer_gid;
+  }
+  if (!call_publish_callback(snapshot_request_pub, publish_callback, &request)) {
+    std::lock_guard<std::mutex> guard(snapshot_mutex);
+    snapshot_peer_gid.reset();
+    return RMW_RET_ERROR;
+  }
   return RMW_RET_OK;
 }
 
+rmw_ret_t Context::handle_graph_snapshot_request(
+  const rmw_dds_common::msg::GraphSnapshotRequest & request)
+{
+  rmw_gid_t responder_gid;
+  convert_msg_to_gid(&request.responder_gid, &responder_gid);
+  if (!(responder_gid == gid)) {
+    return RMW_RET_OK;
+  }
+  rmw_dds_common::msg::GraphSnapshot snapshot = graph_cache.get_snapshot();
+  snapshot.requester_gid = request.requester_gid;
+  snapshot.responder_gid = request.responder_gid;
+  if (!call_publish_callback(snapshot_pub, publish_callback, &snapshot)) {
+    return RMW_RET_ERROR;
+  }
+  return RMW_RET_OK;
+}
+
+bool Context::handle_graph_snapshot(
+  const rmw_dds_common::msg::GraphSnapshot & snapshot,
+  std::chrono::steady_clock::time_point expiry)
+{
+  rmw_gid_t requester_gid;
+  rmw_gid_t responder_gid;
+  convert_msg_to_gid(&snapshot.requester_gid, &requester_gid);
+  convert_msg_to_gid(&snapshot.responder_gid, &responder_gid);
+  {
+    std::lock_guard<std::mutex> guard(snapshot_mutex);
+    if (!snapshot_peer_gid || !(requester_gid == gid) || !(responder_gid == *snapshot_peer_gid)) {
+      return false;
+    }
+    snapshot_peer_gid.reset();
+  }
+  return graph_cache.load_snapshot(snapshot, expiry);
+}
+
 }  // namespace rmw_dds_common
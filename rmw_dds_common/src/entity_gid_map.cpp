@@ -0,0 +1,225 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_dds_common/entity_gid_map.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "rmw/types.h"
+
+#include "rmw_dds_common/gid_utils.hpp"
+
+using rmw_dds_common::EntityGidMap;
+using rmw_dds_common::EntityInfo;
+
+bool
+EntityGidMap::CompareGroupKey::operator()(const GroupKey & lhs, const GroupKey & rhs) const
+{
+  if (lhs.prefix != rhs.prefix) {
+    return lhs.prefix < rhs.prefix;
+  }
+  return Compare_rmw_gid_t{}(lhs.participant_gid, rhs.participant_gid);
+}
+
+bool
+EntityGidMap::CompareGroupKey::operator()(const GroupKey & lhs, const Prefix & rhs) const
+{
+  return lhs.prefix < rhs;
+}
+
+bool
+EntityGidMap::CompareGroupKey::operator()(const Prefix & lhs, const GroupKey & rhs) const
+{
+  return lhs < rhs.prefix;
+}
+
+std::pair<EntityGidMap::Prefix, EntityGidMap::EntityId>
+EntityGidMap::split_gid(const rmw_gid_t & gid)
+{
+  std::pair<Prefix, EntityId> ret;
+  std::copy(gid.data, gid.data + prefix_size, ret.first.begin());
+  ret.second = 0u;
+  for (size_t i = prefix_size; i < RMW_GID_STORAGE_SIZE; i++) {
+    ret.second = (ret.second << 8u) | gid.data[i];
+  }
+  return ret;
+}
+
+rmw_gid_t
+EntityGidMap::join_gid(const Prefix & prefix, EntityId entity_id)
+{
+  rmw_gid_t gid{};
+  uint8_t * data = const_cast<uint8_t *>(gid.data);
+  std::copy(prefix.begin(), prefix.end(), data);
+  for (size_t i = RMW_GID_STORAGE_SIZE; i > prefix_size; i--) {
+    data[i - 1] = static_cast<uint8_t>(entity_id & 0xFFu);
+    entity_id >>= 8u;
+  }
+  return gid;
+}
+
+/// Find the group containing an endpoint, `groups.end()` if not found.
+template<typename GroupsT>
+static
+auto
+__find_group(
+  GroupsT & groups,
+  const EntityGidMap::Prefix & prefix,
+  EntityGidMap::EntityId entity_id) -> decltype(groups.begin())
+{
+  // Usually only one group has the prefix, unless gids don't follow the DDS conventions.
+  auto range = groups.equal_range(prefix);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second.count(entity_id) != 0u) {
+      return it;
+    }
+  }
+  return groups.end();
+}
+
+const EntityInfo *
+EntityGidMap::find(const rmw_gid_t & gid, rmw_gid_t * participant_gid) const
+{
+  auto split = split_gid(gid);
+  auto group_it = __find_group(groups_, split.first, split.second);
+  if (groups_.end() == group_it) {
+    return nullptr;
+  }
+  if (participant_gid) {
+    *participant_gid = group_it->first.participant_gid;
+  }
+  return &group_it->second.at(split.second);
+}
+
+EntityInfo *
+EntityGidMap::find(const rmw_gid_t & gid, rmw_gid_t * participant_gid)
+{
+  return const_cast<EntityInfo *>(std::as_const(*this).find(gid, participant_gid));
+}
+
+size_t
+EntityGidMap::count(const rmw_gid_t & gid) const
+{
+  return nullptr == this->find(gid) ? 0u : 1u;
+}
+
+/// Check if a gid prefix is the one of a participant gid.
+static
+bool
+__matches_participant(const EntityGidMap::Prefix & prefix, const rmw_gid_t & participant_gid)
+{
+  return std::equal(prefix.begin(), prefix.end(), participant_gid.data);
+}
+
+EntityGidMap::Group &
+EntityGidMap::emplace_group(const Prefix & prefix, const rmw_gid_t & participant_gid)
+{
+  auto ret = groups_.try_emplace(GroupKey{prefix, participant_gid});
+  if (ret.second && !__matches_participant(prefix, participant_gid)) {
+    mismatched_groups_++;
+  }
+  return ret.first->second;
+}
+
+void
+EntityGidMap::erase_group(Groups::iterator it)
+{
+  if (!__matches_participant(it->first.prefix, it->first.participant_gid)) {
+    mismatched_groups_--;
+  }
+  groups_.erase(it);
+}
+
+bool
+EntityGidMap::emplace(const rmw_gid_t & gid, const rmw_gid_t & participant_gid, EntityInfo info)
+{
+  auto split = split_gid(gid);
+  if (groups_.end() != __find_group(groups_, split.first, split.second)) {
+    return false;
+  }
+  info.participant_gid = participant_gid;
+  emplace_group(split.first, participant_gid).emplace(split.second, std::move(info));
+  size_++;
+  return true;
+}
+
+bool
+EntityGidMap::insert_or_assign(
+  const rmw_gid_t & gid,
+  const rmw_gid_t & participant_gid,
+  EntityInfo info)
+{
+  auto split = split_gid(gid);
+  auto group_it = __find_group(groups_, split.first, split.second);
+  const bool found = groups_.end() != group_it;
+  info.participant_gid = participant_gid;
+  if (found) {
+    if (group_it->first.participant_gid == participant_gid) {
+      group_it->second.at(split.second) = std::move(info);
+      return false;
+    }
+    group_it->second.erase(split.second);
+    if (group_it->second.empty()) {
+      erase_group(group_it);
+    }
+    size_--;
+  }
+  emplace_group(split.first, participant_gid).emplace(split.second, std::move(info));
+  size_++;
+  return !found;
+}
+
+bool
+EntityGidMap::erase(const rmw_gid_t & gid)
+{
+  auto split = split_gid(gid);
+  auto group_it = __find_group(groups_, split.first, split.second);
+  if (groups_.end() == group_it) {
+    return false;
+  }
+  group_it->second.erase(split.second);
+  if (group_it->second.empty()) {
+    erase_group(group_it);
+  }
+  size_--;
+  return true;
+}
+
+size_t
+EntityGidMap::erase_participant(const rmw_gid_t & participant_gid)
+{
+  size_t erased = 0u;
+  Prefix prefix;
+  std::copy(participant_gid.data, participant_gid.data + prefix_size, prefix.begin());
+  auto it = groups_.find(GroupKey{prefix, participant_gid});
+  if (groups_.end() != it) {
+    erased += it->second.size();
+    groups_.erase(it);
+  }
+  // Only gids that don't follow the DDS conventions end up in other groups.
+  if (0u != mismatched_groups_) {
+    for (it = groups_.begin(); it != groups_.end(); ) {
+      if (it->first.participant_gid == participant_gid) {
+        erased += it->second.size();
+        mismatched_groups_--;
+        it = groups_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  size_ -= erased;
+  return erased;
+}
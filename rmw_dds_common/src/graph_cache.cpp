@@ -16,20 +16,35 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <functional>
+#include <initializer_list>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <ostream>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 #include <vector>
 
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
 #include "rcutils/strdup.h"
 
 #include "rmw/convert_rcutils_ret_to_rmw_ret.h"
@@ -38,176 +53,1647 @@
 #include "rmw/topic_endpoint_info.h"
 #include "rmw/topic_endpoint_info_array.h"
 
+#include "rmw_dds_common/bounded_entities_info.hpp"
+#include "rmw_dds_common/entity_gid_map.hpp"
 #include "rmw_dds_common/gid_utils.hpp"
+#include "rmw_dds_common/qos.hpp"
 
+using rmw_dds_common::ChangeStamp;
+using rmw_dds_common::EntityInfo;
 using rmw_dds_common::GraphCache;
 using rmw_dds_common::operator<<;
+using rmw_dds_common::operator==;
 
 static const char log_tag[] = "rmw_dds_common";
 
 #define GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(graph_cache_ptr, condition) \
   do { \
-    if (graph_cache_ptr->on_change_callback_ && condition) { \
-      graph_cache_ptr->on_change_callback_(); \
+    if (condition) { \
+      graph_cache_ptr->notify_change(); \
+      if (graph_cache_ptr->on_change_callback_) { \
+        graph_cache_ptr->on_change_callback_(); \
+      } \
     } \
   } while (0);
 
 #define GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(graph_cache_ptr) \
   GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(graph_cache_ptr, true)
 
-void
-GraphCache::clear_on_change_callback()
+void
+GraphCache::clear_on_change_callback()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  on_change_callback_ = nullptr;
+}
+
+GraphCache::~GraphCache()
+{
+#if defined(__linux__)
+  if (-1 != change_event_fd_) {
+    close(change_event_fd_);
+  }
+#endif
+}
+
+uint64_t
+GraphCache::get_graph_generation() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return graph_generation_;
+}
+
+int
+GraphCache::get_change_event_fd()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+#if defined(__linux__)
+  if (-1 == change_event_fd_) {
+    change_event_fd_ = eventfd(0u, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (-1 == change_event_fd_) {
+      RCUTILS_LOG_ERROR_NAMED(log_tag, "failed to create graph change eventfd: %d", errno);
+    }
+  }
+#endif
+  return change_event_fd_;
+}
+
+void
+GraphCache::notify_change()
+{
+  graph_generation_++;
+#if defined(__linux__)
+  if (-1 != change_event_fd_) {
+    // Only fails if the counter would overflow, the fd is readable anyway.
+    uint64_t one = 1u;
+    ssize_t ret = write(change_event_fd_, &one, sizeof(one));
+    static_cast<void>(ret);
+  }
+#endif
+}
+
+static
+bool
+__starts_with_any(const std::string & str, const std::vector<std::string> & prefixes)
+{
+  return std::any_of(
+    prefixes.begin(),
+    prefixes.end(),
+    [&str](const std::string & prefix) {
+      return 0 == str.compare(0, prefix.size(), prefix);
+    });
+}
+
+static
+bool
+__is_enclave_filtered_out(const GraphCache::IngestFilter & filter, const std::string & enclave)
+{
+  return !filter.enclaves.empty() &&
+         std::find(filter.enclaves.begin(), filter.enclaves.end(), enclave) ==
+         filter.enclaves.end();
+}
+
+void
+GraphCache::set_ingest_filter(const IngestFilter & filter)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  ingest_filter_ = filter;
+
+  // Apply the new filter to the data already in the cache.
+  bool ret = false;
+  for (auto & item : participants_) {
+    const rmw_gid_t & participant_gid = item.first;
+    ParticipantInfo & info = item.second;
+    // The enclave is unknown until add_participant() is called, it's filtered then.
+    if (!info.enclave.empty()) {
+      const bool was_filtered_out = info.filtered_out;
+      info.filtered_out = __is_enclave_filtered_out(ingest_filter_, info.enclave);
+      if (info.filtered_out && !was_filtered_out) {
+        ingest_filter_stats_.enclave_hits++;
+        index_participant_removal(participant_gid);
+        info.node_entities_info_seq.clear();
+        info.pending_update.reset();
+        participants_with_pending_update_.erase(participant_gid);
+        erase_participant_entities(participant_gid);
+        ret = true;
+      }
+    }
+    if (info.filtered_out || ingest_filter_.node_namespace_prefixes.empty()) {
+      continue;
+    }
+    auto & nodes = info.node_entities_info_seq;
+    for (auto node_it = nodes.begin(); node_it != nodes.end(); ) {
+      if (!is_node_filtered_out(info, *node_it)) {
+        ++node_it;
+        continue;
+      }
+      index_node_change(participant_gid, node_it->node_namespace, node_it->node_name, true);
+      node_it = nodes.erase(node_it);
+      ret = true;
+    }
+  }
+  if (!ingest_filter_.topic_name_prefixes.empty()) {
+    for (EntityGidToInfo * entities : {&data_readers_, &data_writers_}) {
+      std::vector<rmw_gid_t> gids;
+      entities->for_each(
+        [&](const rmw_gid_t & gid, const rmw_gid_t &, const EntityInfo & info) {
+          if (!__starts_with_any(info.topic_name, ingest_filter_.topic_name_prefixes)) {
+            gids.push_back(gid);
+          }
+        });
+      for (const rmw_gid_t & gid : gids) {
+        ingest_filter_stats_.topic_name_hits++;
+        index_entity_change(*entities, gid, true);
+        entities->erase(gid);
+        ret = true;
+      }
+    }
+  }
+  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
+}
+
+GraphCache::IngestFilterStats
+GraphCache::get_ingest_filter_stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ingest_filter_stats_;
+}
+
+static
+bool
+__is_bare_dds_participant(
+  const rmw_dds_common::ParticipantInfo & info,
+  const GraphCache::IngestFilter & filter,
+  std::chrono::steady_clock::time_point now)
+{
+  if (info.is_bare_dds_participant) {
+    return true;
+  }
+  return !info.has_ros_discovery_info &&
+         filter.bare_dds_participant_grace_period &&
+         now - info.discovery_time >= *filter.bare_dds_participant_grace_period;
+}
+
+bool
+GraphCache::is_entity_filtered_out(
+  const rmw_gid_t & gid,
+  const std::string & topic_name,
+  const rmw_gid_t & participant_gid)
+{
+  if (
+    !ingest_filter_.topic_name_prefixes.empty() &&
+    !__starts_with_any(topic_name, ingest_filter_.topic_name_prefixes))
+  {
+    ingest_filter_stats_.topic_name_hits++;
+    return true;
+  }
+  auto it = participants_.find(participant_gid);
+  if (participants_.end() == it) {
+    // Filtered by add_participant() if the participant is filtered out once discovered.
+    return false;
+  }
+  const ParticipantInfo & info = it->second;
+  if (info.filtered_out) {
+    ingest_filter_stats_.enclave_hits++;
+    return true;
+  }
+  if (info.filtered_out_entities.count(gid) != 0u) {
+    ingest_filter_stats_.node_namespace_hits++;
+    return true;
+  }
+  if (__is_bare_dds_participant(info, ingest_filter_, std::chrono::steady_clock::now())) {
+    ingest_filter_stats_.bare_dds_participant_hits++;
+    return true;
+  }
+  return false;
+}
+
+bool
+GraphCache::prune_bare_dds_participants()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!ingest_filter_.bare_dds_participant_grace_period) {
+    return false;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  bool ret = false;
+  for (auto & item : participants_) {
+    ParticipantInfo & info = item.second;
+    if (info.is_bare_dds_participant || !__is_bare_dds_participant(info, ingest_filter_, now)) {
+      continue;
+    }
+    info.is_bare_dds_participant = true;
+    size_t erased = erase_participant_entities(item.first);
+    ingest_filter_stats_.bare_dds_participant_hits += erased;
+    ret = ret || erased > 0u;
+  }
+  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
+  return ret;
+}
+
+bool
+GraphCache::add_writer(
+  const rmw_gid_t & gid,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rosidl_type_hash_t & type_hash,
+  const rmw_gid_t & participant_gid,
+  const rmw_qos_profile_t & qos)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (is_entity_filtered_out(gid, topic_name, participant_gid)) {
+    return false;
+  }
+  if (fold_held_removal(gid, topic_name, type_name, type_hash, participant_gid, qos, false)) {
+    record_churn(&topic_name, participant_gid, true);
+    return true;
+  }
+  bool changed = false;
+  if (
+    confirm_provisional_entity(
+      gid, topic_name, type_name, type_hash, participant_gid, qos, false, &changed))
+  {
+    return changed;
+  }
+  bool ret = data_writers_.emplace(
+    gid, participant_gid, EntityInfo(topic_name, type_name, type_hash, qos));
+  if (ret) {
+    record_churn(&topic_name, participant_gid, true);
+    index_entity_change(data_writers_, gid, false);
+  }
+  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
+  return ret;
+}
+
+bool
+GraphCache::add_writer(
+  const rmw_gid_t & gid,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rmw_gid_t & participant_gid,
+  const rmw_qos_profile_t & qos)
+{
+  return this->add_writer(
+    gid,
+    topic_name,
+    type_name,
+    rosidl_get_zero_initialized_type_hash(),
+    participant_gid,
+    qos);
+}
+
+bool
+GraphCache::add_reader(
+  const rmw_gid_t & gid,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rosidl_type_hash_t & type_hash,
+  const rmw_gid_t & participant_gid,
+  const rmw_qos_profile_t & qos)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (is_entity_filtered_out(gid, topic_name, participant_gid)) {
+    return false;
+  }
+  if (fold_held_removal(gid, topic_name, type_name, type_hash, participant_gid, qos, true)) {
+    record_churn(&topic_name, participant_gid, true);
+    return true;
+  }
+  bool changed = false;
+  if (
+    confirm_provisional_entity(
+      gid, topic_name, type_name, type_hash, participant_gid, qos, true, &changed))
+  {
+    return changed;
+  }
+  bool ret = data_readers_.emplace(
+    gid, participant_gid, EntityInfo(topic_name, type_name, type_hash, qos));
+  if (ret) {
+    record_churn(&topic_name, participant_gid, true);
+    index_entity_change(data_readers_, gid, false);
+  }
+  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
+  return ret;
+}
+
+bool
+GraphCache::add_reader(
+  const rmw_gid_t & gid,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rmw_gid_t & participant_gid,
+  const rmw_qos_profile_t & qos)
+{
+  return this->add_reader(
+    gid,
+    topic_name,
+    type_name,
+    rosidl_get_zero_initialized_type_hash(),
+    participant_gid,
+    qos);
+}
+
+bool
+GraphCache::add_entity(
+  const rmw_gid_t & gid,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rosidl_type_hash_t & type_hash,
+  const rmw_gid_t & participant_gid,
+  const rmw_qos_profile_t & qos,
+  bool is_reader)
+{
+  if (is_reader) {
+    return this->add_reader(
+      gid,
+      topic_name,
+      type_name,
+      type_hash,
+      participant_gid,
+      qos);
+  }
+  return this->add_writer(
+    gid,
+    topic_name,
+    type_name,
+    type_hash,
+    participant_gid,
+    qos);
+}
+
+bool
+GraphCache::add_entity(
+  const rmw_gid_t & gid,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rmw_gid_t & participant_gid,
+  const rmw_qos_profile_t & qos,
+  bool is_reader)
+{
+  return this->add_entity(
+    gid,
+    topic_name,
+    type_name,
+    rosidl_get_zero_initialized_type_hash(),
+    participant_gid,
+    qos,
+    is_reader);
+}
+
+bool
+GraphCache::remove_writer(const rmw_gid_t & gid)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (removal_hysteresis_.count() > 0) {
+    return hold_removal(gid, false);
+  }
+  if (0u == held_removals_.erase(gid)) {
+    // Held removals were already counted.
+    record_entity_removal(data_writers_, gid);
+  }
+  provisional_entities_.erase(gid);
+  index_entity_change(data_writers_, gid, true);
+  bool ret = data_writers_.erase(gid);
+  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
+  return ret;
+}
+
+bool
+GraphCache::remove_reader(const rmw_gid_t & gid)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (removal_hysteresis_.count() > 0) {
+    return hold_removal(gid, true);
+  }
+  if (0u == held_removals_.erase(gid)) {
+    // Held removals were already counted.
+    record_entity_removal(data_readers_, gid);
+  }
+  provisional_entities_.erase(gid);
+  index_entity_change(data_readers_, gid, true);
+  bool ret = data_readers_.erase(gid);
+  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
+  return ret;
+}
+
+bool
+GraphCache::remove_entity(const rmw_gid_t & gid, bool is_reader)
+{
+  if (is_reader) {
+    return this->remove_reader(gid);
+  }
+  return this->remove_writer(gid);
+}
+
+void
+GraphCache::set_removal_hysteresis(std::chrono::nanoseconds period)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  removal_hysteresis_ = period;
+}
+
+bool
+GraphCache::hold_removal(const rmw_gid_t & gid, bool is_reader)
+{
+  const EntityGidToInfo & entities = is_reader ? data_readers_ : data_writers_;
+  if (entities.count(gid) == 0u) {
+    return false;
+  }
+  bool ret = held_removals_.emplace(
+    gid,
+    HeldRemoval{is_reader, std::chrono::steady_clock::now() + removal_hysteresis_}).second;
+  if (ret) {
+    record_entity_removal(entities, gid);
+  }
+  return ret;
+}
+
+static
+bool
+__is_same_qos(const rmw_qos_profile_t & lhs, const rmw_qos_profile_t & rhs)
+{
+  auto is_same_time = [](const rmw_time_t & lhs, const rmw_time_t & rhs) {
+      return lhs.sec == rhs.sec && lhs.nsec == rhs.nsec;
+    };
+  return lhs.history == rhs.history &&
+         lhs.depth == rhs.depth &&
+         lhs.reliability == rhs.reliability &&
+         lhs.durability == rhs.durability &&
+         is_same_time(lhs.deadline, rhs.deadline) &&
+         is_same_time(lhs.lifespan, rhs.lifespan) &&
+         lhs.liveliness == rhs.liveliness &&
+         is_same_time(lhs.liveliness_lease_duration, rhs.liveliness_lease_duration) &&
+         lhs.avoid_ros_namespace_conventions == rhs.avoid_ros_namespace_conventions;
+}
+
+static
+bool
+__is_same_endpoint(
+  const rmw_dds_common::EntityInfo & info,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rosidl_type_hash_t & type_hash,
+  const rmw_qos_profile_t & qos)
+{
+  if (info.topic_name != topic_name || info.topic_type != type_name) {
+    return false;
+  }
+  if (
+    info.topic_type_hash.version != type_hash.version ||
+    0 != memcmp(info.topic_type_hash.value, type_hash.value, sizeof(type_hash.value)))
+  {
+    return false;
+  }
+  return __is_same_qos(info.qos, qos);
+}
+
+bool
+GraphCache::fold_held_removal(
+  const rmw_gid_t & gid,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rosidl_type_hash_t & type_hash,
+  const rmw_gid_t & participant_gid,
+  const rmw_qos_profile_t & qos,
+  bool is_reader)
+{
+  if (held_removals_.empty()) {
+    return false;
+  }
+  EntityGidToInfo & entities = is_reader ? data_readers_ : data_writers_;
+  auto held_it = held_removals_.find(gid);
+  if (held_removals_.end() != held_it) {
+    // Prefer the entity with the same gid, if it changed it's a real removal.
+    EntityInfo * info = entities.find(gid);
+    held_removals_.erase(held_it);
+    if (nullptr == info) {
+      return false;
+    }
+    if (__is_same_endpoint(*info, topic_name, type_name, type_hash, qos)) {
+      if (info->participant_gid == participant_gid) {
+        return true;
+      }
+      entities.insert_or_assign(gid, participant_gid, std::move(*info));
+      index_entity_change(entities, gid, false);
+      GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(this);
+      return true;
+    }
+    index_entity_change(entities, gid, true);
+    entities.erase(gid);
+    return false;
+  }
+  for (held_it = held_removals_.begin(); held_it != held_removals_.end(); ++held_it) {
+    if (held_it->second.is_reader != is_reader) {
+      continue;
+    }
+    const EntityInfo * info = entities.find(held_it->first);
+    if (nullptr == info) {
+      // Already removed by other means, flush_held_removals() will drop it.
+      continue;
+    }
+    if (!__is_same_endpoint(*info, topic_name, type_name, type_hash, qos)) {
+      continue;
+    }
+    index_entity_change(entities, held_it->first, true);
+    entities.erase(held_it->first);
+    held_removals_.erase(held_it);
+    entities.emplace(gid, participant_gid, EntityInfo(topic_name, type_name, type_hash, qos));
+    index_entity_change(entities, gid, false);
+    // The reported gids changed, this is a single change instead of a removal and an addition.
+    GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(this);
+    return true;
+  }
+  return false;
+}
+
+bool
+GraphCache::flush_held_removals(std::chrono::steady_clock::time_point now)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  bool ret = false;
+  for (auto it = held_removals_.begin(); it != held_removals_.end(); ) {
+    if (it->second.deadline > now) {
+      ++it;
+      continue;
+    }
+    EntityGidToInfo & entities = it->second.is_reader ? data_readers_ : data_writers_;
+    index_entity_change(entities, it->first, true);
+    ret = entities.erase(it->first) || ret;
+    it = held_removals_.erase(it);
+  }
+  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
+  return ret;
+}
+
+bool
+GraphCache::flush_held_removals()
+{
+  return this->flush_held_removals(std::chrono::steady_clock::now());
+}
+
+bool
+GraphCache::has_held_removals() const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return !held_removals_.empty();
+}
+
+static
+size_t
+__heap_bytes(const std::string & str)
+{
+  // Short strings are stored inline.
+  static const size_t inline_capacity = std::string().capacity();
+  return str.capacity() > inline_capacity ? str.capacity() + 1u : 0u;
+}
+
+static
+size_t
+__heap_bytes(const rmw_dds_common::msg::NodeEntitiesInfo & info)
+{
+  return __heap_bytes(info.node_namespace) + __heap_bytes(info.node_name) +
+    info.reader_gid_seq.capacity() * sizeof(rmw_dds_common::msg::Gid) +
+    info.writer_gid_seq.capacity() * sizeof(rmw_dds_common::msg::Gid);
+}
+
+static
+size_t
+__heap_bytes(const GraphCache::NodeEntitiesInfoSeq & seq)
+{
+  size_t ret = seq.capacity() * sizeof(rmw_dds_common::msg::NodeEntitiesInfo);
+  for (const auto & info : seq) {
+    ret += __heap_bytes(info);
+  }
+  return ret;
+}
+
+// Approximate size of the bookkeeping of a std::map or std::set node.
+static constexpr size_t tree_node_overhead = 4u * sizeof(void *);
+
+static
+size_t
+__heap_bytes(const rmw_dds_common::ParticipantInfo & info)
+{
+  size_t ret = __heap_bytes(info.node_entities_info_seq) + __heap_bytes(info.enclave) +
+    info.filtered_out_entities.size() * (sizeof(rmw_gid_t) + tree_node_overhead);
+  if (info.pending_update) {
+    ret += __heap_bytes(info.pending_update->node_entities_info_seq);
+  }
+  return ret;
+}
+
+static
+size_t
+__heap_bytes(const rmw_dds_common::EntityInfo & info)
+{
+  return __heap_bytes(info.topic_name) + __heap_bytes(info.topic_type);
+}
+
+static
+size_t
+__heap_bytes(const GraphCache::EntityGidToInfo::Group & group);
+
+template<typename MapT>
+static
+size_t
+__estimate_map_bytes(const MapT & map)
+{
+  size_t ret = map.size() * (sizeof(typename MapT::value_type) + tree_node_overhead);
+  for (const auto & item : map) {
+    ret += __heap_bytes(item.second);
+  }
+  return ret;
+}
+
+static
+size_t
+__heap_bytes(const GraphCache::EntityGidToInfo::Group & group)
+{
+  return __estimate_map_bytes(group);
+}
+
+static
+size_t
+__entry_count(const rmw_dds_common::ParticipantInfo &)
+{
+  return 1u;
+}
+
+static
+size_t
+__entry_count(const GraphCache::EntityGidToInfo::Group & group)
+{
+  return group.size();
+}
+
+/// Reallocate entries of `map` from `cursor`, until the end of the map or running out of budget.
+/**
+ * \return `true` if the end of the map was reached, `false` otherwise.
+ */
+template<typename MapT>
+static
+bool
+__compact_entries(
+  MapT & map,
+  std::optional<typename MapT::key_type> & cursor,
+  size_t & budget,
+  GraphCache::MemoryStats & stats)
+{
+  auto it = cursor ? map.lower_bound(*cursor) : map.begin();
+  while (map.end() != it && 0u < budget) {
+    // Copies are allocated with the exact size, while the original may have grown with churn.
+    typename MapT::mapped_type compacted = it->second;
+    const size_t before = __heap_bytes(it->second);
+    const size_t after = __heap_bytes(compacted);
+    const size_t entries = __entry_count(it->second);
+    stats.reclaimed_bytes += before > after ? before - after : 0u;
+    stats.compacted_entries += entries;
+    // A group of endpoints is reallocated at once, even if it's larger than the budget.
+    budget -= std::min(budget, entries);
+    // The map node is reallocated too, the extracted one is released at the end of the scope.
+    auto node = map.extract(it++);
+    map.emplace_hint(it, node.key(), std::move(compacted));
+  }
+  if (map.end() == it) {
+    cursor.reset();
+    return true;
+  }
+  cursor = it->first;
+  return false;
+}
+
+GraphCache::MemoryStats
+GraphCache::get_memory_stats() const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  MemoryStats stats = memory_stats_;
+  stats.participants = participants_.size();
+  stats.nodes = 0u;
+  for (const auto & item : participants_) {
+    stats.nodes += item.second.node_entities_info_seq.size();
+  }
+  stats.entities = data_readers_.size() + data_writers_.size();
+  stats.estimated_bytes =
+    __estimate_map_bytes(participants_) +
+    __estimate_map_bytes(data_readers_.groups()) +
+    __estimate_map_bytes(data_writers_.groups());
+  return stats;
+}
+
+void
+GraphCache::set_compaction_trim_threshold(size_t bytes)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  compaction_trim_threshold_ = bytes;
+}
+
+bool
+GraphCache::compact(size_t max_entries)
+{
+  if (0u == max_entries) {
+    return false;
+  }
+  bool trim = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    size_t budget = max_entries;
+    if (CompactionStage::participants == compaction_stage_) {
+      if (!__compact_entries(participants_, compaction_cursor_, budget, memory_stats_)) {
+        return false;
+      }
+      compaction_stage_ = CompactionStage::data_readers;
+    }
+    if (CompactionStage::data_readers == compaction_stage_) {
+      if (
+        !__compact_entries(
+          data_readers_.groups(), entity_compaction_cursor_, budget, memory_stats_))
+      {
+        return false;
+      }
+      compaction_stage_ = CompactionStage::data_writers;
+    }
+    if (
+      !__compact_entries(
+        data_writers_.groups(), entity_compaction_cursor_, budget, memory_stats_))
+    {
+      return false;
+    }
+    compaction_stage_ = CompactionStage::participants;
+    memory_stats_.compaction_passes++;
+#if defined(__GLIBC__)
+    // Trimming walks the whole heap, only do it once enough memory was released.
+    trim = 0u != compaction_trim_threshold_ &&
+      memory_stats_.reclaimed_bytes - trimmed_reclaimed_bytes_ >= compaction_trim_threshold_;
+    if (trim) {
+      trimmed_reclaimed_bytes_ = memory_stats_.reclaimed_bytes;
+      memory_stats_.trims++;
+    }
+#endif
+  }
+#if defined(__GLIBC__)
+  // Without this, glibc keeps the released memory and RSS doesn't go down.
+  if (trim) {
+    malloc_trim(0);
+  }
+#else
+  static_cast<void>(trim);
+#endif
+  return true;
+}
+
+void
+GraphCache::set_churn_window(const ChurnWindow & window)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  churn_window_ = window;
+  churn_window_.bucket_count = std::max<size_t>(window.bucket_count, 1u);
+  churn_window_start_ = std::chrono::steady_clock::now();
+  churn_newest_index_ = 0;
+  topic_churn_.clear();
+  participant_churn_.clear();
+}
+
+static
+int64_t
+__churn_bucket_index(
+  const GraphCache::ChurnWindow & window,
+  std::chrono::steady_clock::time_point start,
+  std::chrono::steady_clock::time_point now)
+{
+  if (now <= start) {
+    return 0;
+  }
+  return static_cast<int64_t>((now - start) / window.bucket_period);
+}
+
+template<typename ChurnBucketsT>
+static
+void
+__count_churn(ChurnBucketsT & buckets, size_t bucket_count, int64_t index, bool added)
+{
+  if (buckets.empty()) {
+    buckets.resize(bucket_count);
+  }
+  auto & bucket = buckets[static_cast<size_t>(index) % bucket_count];
+  if (bucket.index != index) {
+    // The slot holds the counts of a bucket that already left the window.
+    bucket.index = index;
+    bucket.added = 0u;
+    bucket.removed = 0u;
+  }
+  if (added) {
+    bucket.added++;
+  } else {
+    bucket.removed++;
+  }
+}
+
+/// Sum the buckets within the window ending with bucket `newest`.
+template<typename ChurnBucketsT>
+static
+std::pair<size_t, size_t>
+__sum_churn(const ChurnBucketsT & buckets, size_t bucket_count, int64_t newest)
+{
+  std::pair<size_t, size_t> ret{0u, 0u};
+  for (const auto & bucket : buckets) {
+    if (
+      0 <= bucket.index && bucket.index <= newest &&
+      newest - bucket.index < static_cast<int64_t>(bucket_count))
+    {
+      ret.first += bucket.added;
+      ret.second += bucket.removed;
+    }
+  }
+  return ret;
+}
+
+template<typename ChurnMapT>
+static
+void
+__prune_churn(ChurnMapT & churn, size_t bucket_count, int64_t newest)
+{
+  for (auto it = churn.begin(); it != churn.end(); ) {
+    auto sum = __sum_churn(it->second, bucket_count, newest);
+    if (0u == sum.first && 0u == sum.second) {
+      it = churn.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+template<typename ResultT, typename ChurnMapT, typename MakeResultT>
+static
+std::vector<ResultT>
+__get_top_churn(
+  const ChurnMapT & churn,
+  size_t bucket_count,
+  int64_t newest,
+  size_t max_count,
+  MakeResultT make_result)
+{
+  std::vector<ResultT> ret;
+  for (const auto & item : churn) {
+    auto sum = __sum_churn(item.second, bucket_count, newest);
+    if (0u != sum.first || 0u != sum.second) {
+      ret.push_back(make_result(item.first, sum.first, sum.second));
+    }
+  }
+  std::stable_sort(
+    ret.begin(),
+    ret.end(),
+    [](const ResultT & lhs, const ResultT & rhs) {
+      return lhs.added + lhs.removed > rhs.added + rhs.removed;
+    });
+  if (ret.size() > max_count) {
+    ret.resize(max_count);
+  }
+  return ret;
+}
+
+void
+GraphCache::record_churn(
+  const std::string * topic_name,
+  const rmw_gid_t & participant_gid,
+  bool added)
+{
+  if (churn_window_.bucket_period.count() <= 0) {
+    return;
+  }
+  const size_t bucket_count = churn_window_.bucket_count;
+  const int64_t index = __churn_bucket_index(
+    churn_window_, churn_window_start_, std::chrono::steady_clock::now());
+  if (index > churn_newest_index_) {
+    // Drop the counters that left the window once per bucket, so they don't pile up.
+    churn_newest_index_ = index;
+    __prune_churn(topic_churn_, bucket_count, index);
+    __prune_churn(participant_churn_, bucket_count, index);
+  }
+  if (topic_name) {
+    __count_churn(topic_churn_[*topic_name], bucket_count, index, added);
+  }
+  __count_churn(participant_churn_[participant_gid], bucket_count, index, added);
+}
+
+void
+GraphCache::record_entity_removal(const EntityGidToInfo & entities, const rmw_gid_t & gid)
+{
+  if (churn_window_.bucket_period.count() <= 0) {
+    return;
+  }
+  rmw_gid_t participant_gid;
+  const EntityInfo * info = entities.find(gid, &participant_gid);
+  if (info) {
+    record_churn(&info->topic_name, participant_gid, false);
+  }
+}
+
+std::vector<GraphCache::TopicChurn>
+GraphCache::get_top_churn_topics(
+  size_t max_count,
+  std::chrono::steady_clock::time_point now) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (churn_window_.bucket_period.count() <= 0) {
+    return {};
+  }
+  return __get_top_churn<TopicChurn>(
+    topic_churn_,
+    churn_window_.bucket_count,
+    __churn_bucket_index(churn_window_, churn_window_start_, now),
+    max_count,
+    [](const std::string & topic_name, size_t added, size_t removed) {
+      return TopicChurn{topic_name, added, removed};
+    });
+}
+
+std::vector<GraphCache::TopicChurn>
+GraphCache::get_top_churn_topics(size_t max_count) const
+{
+  return this->get_top_churn_topics(max_count, std::chrono::steady_clock::now());
+}
+
+std::vector<GraphCache::ParticipantChurn>
+GraphCache::get_top_churn_participants(
+  size_t max_count,
+  std::chrono::steady_clock::time_point now) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (churn_window_.bucket_period.count() <= 0) {
+    return {};
+  }
+  return __get_top_churn<ParticipantChurn>(
+    participant_churn_,
+    churn_window_.bucket_count,
+    __churn_bucket_index(churn_window_, churn_window_start_, now),
+    max_count,
+    [](const rmw_gid_t & participant_gid, size_t added, size_t removed) {
+      return ParticipantChurn{participant_gid, added, removed};
+    });
+}
+
+std::vector<GraphCache::ParticipantChurn>
+GraphCache::get_top_churn_participants(size_t max_count) const
+{
+  return this->get_top_churn_participants(max_count, std::chrono::steady_clock::now());
+}
+
+void
+GraphCache::set_change_index_config(const ChangeIndexConfig & config)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  const bool was_enabled = change_index_config_.enabled;
+  change_index_config_ = config;
+  if (!config.enabled || !was_enabled) {
+    change_index_.clear();
+    change_index_tombstones_.clear();
+    // Drop the stamps of a previous index, so they don't refer to missing entries.
+    auto clear_stamps = [](EntityGidToInfo & entities) {
+        for (auto & group_item : entities.groups()) {
+          for (auto & item : group_item.second) {
+            item.second.change_stamp = ChangeStamp{};
+          }
+        }
+      };
+    clear_stamps(data_readers_);
+    clear_stamps(data_writers_);
+    for (auto & item : participants_) {
+      item.second.node_change_stamps.clear();
+    }
+    // Earlier changes are not in the index.
+    change_index_complete_since_ =
+      ChangeStamp{graph_generation_, std::chrono::steady_clock::now()};
+  }
+  trim_change_index();
+}
+
+void
+GraphCache::trim_change_index()
+{
+  while (change_index_tombstones_.size() > change_index_config_.max_tombstones) {
+    auto it = change_index_tombstones_.front();
+    change_index_tombstones_.pop_front();
+    if (it->first.generation > change_index_complete_since_.generation) {
+      change_index_complete_since_ = it->first;
+    }
+    change_index_.erase(it);
+  }
+}
+
+ChangeStamp
+GraphCache::index_change(const ChangeStamp & previous, GraphChange change)
+{
+  if (0u != previous.generation) {
+    auto range = change_index_.equal_range(previous.generation);
+    for (auto it = range.first; it != range.second; ++it) {
+      const GraphChange & entry = it->second;
+      if (
+        !entry.removed && entry.kind == change.kind && entry.gid == change.gid &&
+        entry.node_namespace == change.node_namespace && entry.node_name == change.node_name)
+      {
+        change_index_.erase(it);
+        break;
+      }
+    }
+  }
+  // Stamped with the generation set by the notify_change() following the modification,
+  // queries don't report it until that generation is published.
+  const ChangeStamp stamp{graph_generation_ + 1u, std::chrono::steady_clock::now()};
+  const bool removed = change.removed;
+  auto it = change_index_.emplace(stamp, std::move(change));
+  if (removed) {
+    change_index_tombstones_.push_back(it);
+    trim_change_index();
+  }
+  return stamp;
+}
+
+void
+GraphCache::index_entity_change(EntityGidToInfo & entities, const rmw_gid_t & gid, bool removed)
+{
+  if (!change_index_config_.enabled) {
+    return;
+  }
+  EntityInfo * info = entities.find(gid);
+  if (nullptr == info) {
+    return;
+  }
+  GraphChange change;
+  change.kind = &entities == &data_readers_ ?
+    GraphChange::Kind::data_reader : GraphChange::Kind::data_writer;
+  change.removed = removed;
+  change.gid = gid;
+  change.topic_name = info->topic_name;
+  info->change_stamp = index_change(info->change_stamp, std::move(change));
+}
+
+void
+GraphCache::index_node_change(
+  const rmw_gid_t & participant_gid,
+  const std::string & node_namespace,
+  const std::string & node_name,
+  bool removed)
+{
+  if (!change_index_config_.enabled) {
+    return;
+  }
+  auto participant_it = participants_.find(participant_gid);
+  if (participants_.end() == participant_it) {
+    return;
+  }
+  ParticipantInfo & info = participant_it->second;
+  GraphChange change;
+  change.kind = GraphChange::Kind::node;
+  change.removed = removed;
+  change.gid = participant_gid;
+  change.node_namespace = node_namespace;
+  change.node_name = node_name;
+  auto key = std::make_pair(node_namespace, node_name);
+  auto stamp_it = info.node_change_stamps.find(key);
+  ChangeStamp previous;
+  if (info.node_change_stamps.end() != stamp_it) {
+    previous = stamp_it->second;
+  }
+  ChangeStamp stamp = index_change(previous, std::move(change));
+  if (removed) {
+    if (info.node_change_stamps.end() != stamp_it) {
+      info.node_change_stamps.erase(stamp_it);
+    }
+  } else {
+    info.node_change_stamps[std::move(key)] = stamp;
+  }
+}
+
+void
+GraphCache::index_node_changes(
+  const rmw_gid_t & participant_gid,
+  const ParticipantInfo & info,
+  const NodeEntitiesInfoSeq & previous_nodes)
+{
+  if (!change_index_config_.enabled) {
+    return;
+  }
+  auto find_node = [](const NodeEntitiesInfoSeq & nodes, const auto & node) {
+      return std::find_if(
+        nodes.begin(), nodes.end(),
+        [&node](const rmw_dds_common::msg::NodeEntitiesInfo & other) {
+          return other.node_namespace == node.node_namespace && other.node_name == node.node_name;
+        });
+    };
+  for (const auto & node : previous_nodes) {
+    if (info.node_entities_info_seq.end() == find_node(info.node_entities_info_seq, node)) {
+      index_node_change(participant_gid, node.node_namespace, node.node_name, true);
+    }
+  }
+  for (const auto & node : info.node_entities_info_seq) {
+    auto previous_it = find_node(previous_nodes, node);
+    if (previous_nodes.end() == previous_it || !(*previous_it == node)) {
+      index_node_change(participant_gid, node.node_namespace, node.node_name, false);
+    }
+  }
+}
+
+void
+GraphCache::index_participant_removal(const rmw_gid_t & participant_gid)
+{
+  if (!change_index_config_.enabled) {
+    return;
+  }
+  auto it = participants_.find(participant_gid);
+  if (participants_.end() == it) {
+    return;
+  }
+  for (const auto & node : it->second.node_entities_info_seq) {
+    index_node_change(participant_gid, node.node_namespace, node.node_name, true);
+  }
+}
+
+size_t
+GraphCache::erase_participant_entities(const rmw_gid_t & participant_gid)
+{
+  if (change_index_config_.enabled) {
+    for (EntityGidToInfo * entities : {&data_readers_, &data_writers_}) {
+      std::vector<rmw_gid_t> gids;
+      entities->for_each(
+        [&](const rmw_gid_t & gid, const rmw_gid_t & entity_participant_gid, const EntityInfo &) {
+          if (entity_participant_gid == participant_gid) {
+            gids.push_back(gid);
+          }
+        });
+      for (const rmw_gid_t & gid : gids) {
+        index_entity_change(*entities, gid, true);
+      }
+    }
+  }
+  size_t erased = data_writers_.erase_participant(participant_gid);
+  return erased + data_readers_.erase_participant(participant_gid);
+}
+
+/// Append the changes in [first, last) to `changes`.
+template<typename IteratorT>
+static
+void
+__collect_changes(
+  IteratorT first,
+  IteratorT last,
+  std::vector<GraphCache::GraphChange> & changes)
+{
+  changes.reserve(static_cast<size_t>(std::distance(first, last)));
+  for (auto it = first; it != last; ++it) {
+    changes.push_back(it->second);
+    changes.back().stamp = it->first;
+  }
+}
+
+GraphCache::GraphChanges
+GraphCache::get_changes_since(uint64_t generation) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  GraphChanges ret;
+  ret.generation = graph_generation_;
+  if (!change_index_config_.enabled) {
+    ret.truncated = true;
+    return ret;
+  }
+  ret.truncated = generation < change_index_complete_since_.generation;
+  __collect_changes(
+    change_index_.upper_bound(generation), change_index_.upper_bound(graph_generation_),
+    ret.changes);
+  return ret;
+}
+
+GraphCache::GraphChanges
+GraphCache::get_changes_since(std::chrono::steady_clock::time_point time) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  GraphChanges ret;
+  ret.generation = graph_generation_;
+  if (!change_index_config_.enabled) {
+    ret.truncated = true;
+    return ret;
+  }
+  ret.truncated = time < change_index_complete_since_.time;
+  __collect_changes(
+    change_index_.upper_bound(time), change_index_.upper_bound(graph_generation_), ret.changes);
+  return ret;
+}
+
+void
+GraphCache::update_participant_entities(const rmw_dds_common::msg::ParticipantEntitiesInfo & msg)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  rmw_gid_t gid;
+  rmw_dds_common::convert_msg_to_gid(&msg.gid, &gid);
+  auto it = participants_.find(gid);
+  if (participants_.end() == it) {
+    auto ret = participants_.emplace(
+      std::piecewise_construct,
+      std::forward_as_tuple(gid),
+      std::forward_as_tuple());
+    it = ret.first;
+    assert(ret.second);
+  }
+  ParticipantInfo & info = it->second;
+  if (info.filtered_out) {
+    ingest_filter_stats_.enclave_hits++;
+    return;
+  }
+  info.has_ros_discovery_info = true;
+  info.is_bare_dds_participant = false;
+  provisional_participants_.erase(gid);
+  if (!consume_update_token(info, std::chrono::steady_clock::now())) {
+    update_rate_limit_stats_.throttled_updates++;
+    if (info.pending_update) {
+      update_rate_limit_stats_.coalesced_updates++;
+    }
+    info.pending_update = msg;
+    participants_with_pending_update_.insert(gid);
+    return;
+  }
+  if (info.pending_update) {
+    // The pending update is older than this one.
+    update_rate_limit_stats_.coalesced_updates++;
+    info.pending_update.reset();
+    participants_with_pending_update_.erase(gid);
+  }
+  apply_participant_entities(info, msg);
+  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(this);
+}
+
+bool
+GraphCache::confirm_provisional_entity(
+  const rmw_gid_t & gid,
+  const std::string & topic_name,
+  const std::string & type_name,
+  const rosidl_type_hash_t & type_hash,
+  const rmw_gid_t & participant_gid,
+  const rmw_qos_profile_t & qos,
+  bool is_reader,
+  bool * changed)
+{
+  if (0u == provisional_entities_.erase(gid)) {
+    return false;
+  }
+  EntityGidToInfo & entities = is_reader ? data_readers_ : data_writers_;
+  rmw_gid_t previous_participant_gid;
+  const EntityInfo * info = entities.find(gid, &previous_participant_gid);
+  if (nullptr == info) {
+    return false;
+  }
+  // Live discovery data wins over the snapshot.
+  *changed =
+    !(previous_participant_gid == participant_gid) ||
+    !__is_same_endpoint(*info, topic_name, type_name, type_hash, qos);
+  EntityInfo new_info(topic_name, type_name, type_hash, qos);
+  new_info.change_stamp = info->change_stamp;
+  entities.insert_or_assign(gid, participant_gid, std::move(new_info));
+  if (*changed) {
+    index_entity_change(entities, gid, false);
+  }
+  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, *changed);
+  return true;
+}
+
+static
+rmw_dds_common::msg::ParticipantEntitiesInfo
+__create_participant_info_message(
+  const rmw_gid_t & gid,
+  const GraphCache::NodeEntitiesInfoSeq & info)
 {
-  std::lock_guard<std::mutex> lock(mutex_);
-  on_change_callback_ = nullptr;
+  rmw_dds_common::msg::ParticipantEntitiesInfo msg;
+  rmw_dds_common::convert_gid_to_msg(&gid, &msg.gid);
+  msg.node_entities_info_seq = info;
+  return msg;
 }
 
-bool
-GraphCache::add_writer(
+static
+rmw_dds_common::msg::GraphSnapshotEntity
+__create_snapshot_entity(
   const rmw_gid_t & gid,
-  const std::string & topic_name,
-  const std::string & type_name,
-  const rosidl_type_hash_t & type_hash,
   const rmw_gid_t & participant_gid,
-  const rmw_qos_profile_t & qos)
+  const rmw_dds_common::EntityInfo & info,
+  bool is_reader)
+{
+  rmw_dds_common::msg::GraphSnapshotEntity msg;
+  rmw_dds_common::convert_gid_to_msg(&gid, &msg.gid);
+  rmw_dds_common::convert_gid_to_msg(&participant_gid, &msg.participant_gid);
+  msg.topic_name = info.topic_name;
+  msg.topic_type = info.topic_type;
+  msg.topic_type_hash_version = info.topic_type_hash.version;
+  std::copy(
+    std::begin(info.topic_type_hash.value),
+    std::end(info.topic_type_hash.value),
+    msg.topic_type_hash_value.begin());
+  msg.is_reader = is_reader;
+  msg.history = static_cast<uint8_t>(info.qos.history);
+  msg.depth = info.qos.depth;
+  msg.reliability = static_cast<uint8_t>(info.qos.reliability);
+  msg.durability = static_cast<uint8_t>(info.qos.durability);
+  msg.deadline_sec = info.qos.deadline.sec;
+  msg.deadline_nsec = info.qos.deadline.nsec;
+  msg.lifespan_sec = info.qos.lifespan.sec;
+  msg.lifespan_nsec = info.qos.lifespan.nsec;
+  msg.liveliness = static_cast<uint8_t>(info.qos.liveliness);
+  msg.liveliness_lease_duration_sec = info.qos.liveliness_lease_duration.sec;
+  msg.liveliness_lease_duration_nsec = info.qos.liveliness_lease_duration.nsec;
+  msg.avoid_ros_namespace_conventions = info.qos.avoid_ros_namespace_conventions;
+  return msg;
+}
+
+static
+rmw_qos_profile_t
+__qos_from_snapshot_entity(const rmw_dds_common::msg::GraphSnapshotEntity & msg)
+{
+  rmw_qos_profile_t qos{};
+  qos.history = static_cast<rmw_qos_history_policy_t>(msg.history);
+  qos.depth = static_cast<size_t>(msg.depth);
+  qos.reliability = static_cast<rmw_qos_reliability_policy_t>(msg.reliability);
+  qos.durability = static_cast<rmw_qos_durability_policy_t>(msg.durability);
+  qos.deadline = {msg.deadline_sec, msg.deadline_nsec};
+  qos.lifespan = {msg.lifespan_sec, msg.lifespan_nsec};
+  qos.liveliness = static_cast<rmw_qos_liveliness_policy_t>(msg.liveliness);
+  qos.liveliness_lease_duration =
+  {msg.liveliness_lease_duration_sec, msg.liveliness_lease_duration_nsec};
+  qos.avoid_ros_namespace_conventions = msg.avoid_ros_namespace_conventions;
+  return qos;
+}
+
+rmw_dds_common::msg::GraphSnapshot
+GraphCache::get_snapshot() const
 {
   std::lock_guard<std::mutex> guard(mutex_);
-  auto pair = data_writers_.emplace(
-    std::piecewise_construct,
-    std::forward_as_tuple(gid),
-    std::forward_as_tuple(topic_name, type_name, type_hash, participant_gid, qos));
-  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, pair.second);
-  return pair.second;
+  rmw_dds_common::msg::GraphSnapshot snapshot;
+  snapshot.participants.reserve(participants_.size());
+  for (const auto & item : participants_) {
+    if (item.second.filtered_out) {
+      continue;
+    }
+    snapshot.participants.emplace_back();
+    auto & participant = snapshot.participants.back();
+    participant.info = __create_participant_info_message(
+      item.first, item.second.node_entities_info_seq);
+    participant.enclave = item.second.enclave;
+  }
+  snapshot.entities.reserve(data_readers_.size() + data_writers_.size());
+  auto add_entities = [this, &snapshot](const EntityGidToInfo & entities, bool is_reader) {
+      entities.for_each(
+        [&](const rmw_gid_t & gid, const rmw_gid_t & participant_gid, const EntityInfo & info) {
+          if (0u == held_removals_.count(gid)) {
+            snapshot.entities.push_back(
+              __create_snapshot_entity(gid, participant_gid, info, is_reader));
+          }
+        });
+    };
+  add_entities(data_readers_, true);
+  add_entities(data_writers_, false);
+  return snapshot;
 }
 
 bool
-GraphCache::add_writer(
-  const rmw_gid_t & gid,
-  const std::string & topic_name,
-  const std::string & type_name,
-  const rmw_gid_t & participant_gid,
-  const rmw_qos_profile_t & qos)
+GraphCache::load_snapshot(
+  const rmw_dds_common::msg::GraphSnapshot & snapshot,
+  std::chrono::steady_clock::time_point expiry)
 {
-  return this->add_writer(
-    gid,
-    topic_name,
-    type_name,
-    rosidl_get_zero_initialized_type_hash(),
-    participant_gid,
-    qos);
+  std::lock_guard<std::mutex> guard(mutex_);
+  bool ret = false;
+  for (const auto & participant : snapshot.participants) {
+    rmw_gid_t gid;
+    rmw_dds_common::convert_msg_to_gid(&participant.info.gid, &gid);
+    if (participants_.count(gid) != 0u) {
+      continue;
+    }
+    if (__is_enclave_filtered_out(ingest_filter_, participant.enclave)) {
+      ingest_filter_stats_.enclave_hits++;
+      continue;
+    }
+    ParticipantInfo & info = participants_[gid];
+    info.enclave = participant.enclave;
+    info.has_ros_discovery_info = true;
+    apply_participant_entities(info, participant.info);
+    provisional_participants_[gid] = expiry;
+    ret = true;
+  }
+  for (const auto & entity : snapshot.entities) {
+    rmw_gid_t gid;
+    rmw_dds_common::convert_msg_to_gid(&entity.gid, &gid);
+    EntityGidToInfo & entities = entity.is_reader ? data_readers_ : data_writers_;
+    if (entities.count(gid) != 0u) {
+      continue;
+    }
+    rmw_gid_t participant_gid;
+    rmw_dds_common::convert_msg_to_gid(&entity.participant_gid, &participant_gid);
+    if (is_entity_filtered_out(gid, entity.topic_name, participant_gid)) {
+      continue;
+    }
+    rosidl_type_hash_t type_hash = rosidl_get_zero_initialized_type_hash();
+    type_hash.version = entity.topic_type_hash_version;
+    std::copy(
+      entity.topic_type_hash_value.begin(),
+      entity.topic_type_hash_value.end(),
+      std::begin(type_hash.value));
+    entities.emplace(
+      gid,
+      participant_gid,
+      EntityInfo(
+        entity.topic_name,
+        entity.topic_type,
+        type_hash,
+        __qos_from_snapshot_entity(entity)));
+    index_entity_change(entities, gid, false);
+    provisional_entities_[gid] = expiry;
+    ret = true;
+  }
+  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
+  return ret;
 }
 
 bool
-GraphCache::add_reader(
-  const rmw_gid_t & gid,
-  const std::string & topic_name,
-  const std::string & type_name,
-  const rosidl_type_hash_t & type_hash,
-  const rmw_gid_t & participant_gid,
-  const rmw_qos_profile_t & qos)
+GraphCache::expire_provisional_entries(std::chrono::steady_clock::time_point now)
 {
   std::lock_guard<std::mutex> guard(mutex_);
-  auto pair = data_readers_.emplace(
-    std::piecewise_construct,
-    std::forward_as_tuple(gid),
-    std::forward_as_tuple(topic_name, type_name, type_hash, participant_gid, qos));
-  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, pair.second);
-  return pair.second;
+  bool ret = false;
+  for (auto it = provisional_participants_.begin(); it != provisional_participants_.end(); ) {
+    if (it->second > now) {
+      ++it;
+      continue;
+    }
+    participants_with_pending_update_.erase(it->first);
+    index_participant_removal(it->first);
+    ret = participants_.erase(it->first) > 0u || ret;
+    it = provisional_participants_.erase(it);
+  }
+  for (auto it = provisional_entities_.begin(); it != provisional_entities_.end(); ) {
+    if (it->second > now) {
+      ++it;
+      continue;
+    }
+    held_removals_.erase(it->first);
+    index_entity_change(data_readers_, it->first, true);
+    index_entity_change(data_writers_, it->first, true);
+    ret = data_readers_.erase(it->first) || ret;
+    ret = data_writers_.erase(it->first) || ret;
+    it = provisional_entities_.erase(it);
+  }
+  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
+  return ret;
 }
 
 bool
-GraphCache::add_reader(
-  const rmw_gid_t & gid,
-  const std::string & topic_name,
-  const std::string & type_name,
-  const rmw_gid_t & participant_gid,
-  const rmw_qos_profile_t & qos)
+GraphCache::expire_provisional_entries()
 {
-  return this->add_reader(
-    gid,
-    topic_name,
-    type_name,
-    rosidl_get_zero_initialized_type_hash(),
-    participant_gid,
-    qos);
+  return this->expire_provisional_entries(std::chrono::steady_clock::now());
 }
 
 bool
-GraphCache::add_entity(
-  const rmw_gid_t & gid,
-  const std::string & topic_name,
-  const std::string & type_name,
-  const rosidl_type_hash_t & type_hash,
-  const rmw_gid_t & participant_gid,
-  const rmw_qos_profile_t & qos,
-  bool is_reader)
+GraphCache::has_provisional_entries() const
 {
-  if (is_reader) {
-    return this->add_reader(
-      gid,
-      topic_name,
-      type_name,
-      type_hash,
-      participant_gid,
-      qos);
-  }
-  return this->add_writer(
-    gid,
-    topic_name,
-    type_name,
-    type_hash,
-    participant_gid,
-    qos);
+  std::lock_guard<std::mutex> guard(mutex_);
+  return !provisional_participants_.empty() || !provisional_entities_.empty();
+}
+
+void
+GraphCache::update_participant_entities(
+  const rmw_dds_common::msg::BoundedParticipantEntitiesInfo & msg)
+{
+  rmw_dds_common::msg::ParticipantEntitiesInfo unbounded_msg;
+  rmw_dds_common::convert_from_bounded_msg(&msg, &unbounded_msg);
+  this->update_participant_entities(unbounded_msg);
+}
+
+void
+GraphCache::set_update_rate_limit(const UpdateRateLimit & rate_limit)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  update_rate_limit_ = rate_limit;
+  update_rate_limit_.burst = std::max<size_t>(1u, rate_limit.burst);
+}
+
+GraphCache::UpdateRateLimitStats
+GraphCache::get_update_rate_limit_stats() const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return update_rate_limit_stats_;
 }
 
 bool
-GraphCache::add_entity(
-  const rmw_gid_t & gid,
-  const std::string & topic_name,
-  const std::string & type_name,
-  const rmw_gid_t & participant_gid,
-  const rmw_qos_profile_t & qos,
-  bool is_reader)
+GraphCache::consume_update_token(
+  ParticipantInfo & info,
+  std::chrono::steady_clock::time_point now)
 {
-  return this->add_entity(
-    gid,
-    topic_name,
-    type_name,
-    rosidl_get_zero_initialized_type_hash(),
-    participant_gid,
-    qos,
-    is_reader);
+  if (update_rate_limit_.updates_per_second <= 0.0) {
+    return true;
+  }
+  const double burst = static_cast<double>(update_rate_limit_.burst);
+  if (now > info.last_update_refill_time) {
+    const std::chrono::duration<double> elapsed = now - info.last_update_refill_time;
+    info.update_tokens = std::min(
+      burst,
+      info.update_tokens + elapsed.count() * update_rate_limit_.updates_per_second);
+    info.last_update_refill_time = now;
+  }
+  if (info.update_tokens < 1.0) {
+    return false;
+  }
+  info.update_tokens -= 1.0;
+  return true;
 }
 
 bool
-GraphCache::remove_writer(const rmw_gid_t & gid)
+GraphCache::flush_pending_participant_updates(std::chrono::steady_clock::time_point now)
 {
   std::lock_guard<std::mutex> guard(mutex_);
-  bool ret = data_writers_.erase(gid) > 0;
+  bool ret = false;
+  for (auto gid_it = participants_with_pending_update_.begin();
+    gid_it != participants_with_pending_update_.end(); )
+  {
+    auto it = participants_.find(*gid_it);
+    if (participants_.end() == it || !it->second.pending_update) {
+      gid_it = participants_with_pending_update_.erase(gid_it);
+      continue;
+    }
+    ParticipantInfo & info = it->second;
+    if (!consume_update_token(info, now)) {
+      ++gid_it;
+      continue;
+    }
+    apply_participant_entities(info, *info.pending_update);
+    info.pending_update.reset();
+    update_rate_limit_stats_.flushed_updates++;
+    gid_it = participants_with_pending_update_.erase(gid_it);
+    ret = true;
+  }
   GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
   return ret;
 }
 
 bool
-GraphCache::remove_reader(const rmw_gid_t & gid)
+GraphCache::flush_pending_participant_updates()
+{
+  return this->flush_pending_participant_updates(std::chrono::steady_clock::now());
+}
+
+bool
+GraphCache::has_pending_participant_updates() const
 {
   std::lock_guard<std::mutex> guard(mutex_);
-  bool ret = data_readers_.erase(gid) > 0;
-  GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
-  return ret;
+  return !participants_with_pending_update_.empty();
+}
+
+void
+GraphCache::apply_participant_entities(
+  ParticipantInfo & info,
+  const rmw_dds_common::msg::ParticipantEntitiesInfo & msg)
+{
+  NodeEntitiesInfoSeq previous_nodes;
+  if (change_index_config_.enabled) {
+    previous_nodes = info.node_entities_info_seq;
+  }
+  if (ingest_filter_.node_namespace_prefixes.empty()) {
+    info.node_entities_info_seq = msg.node_entities_info_seq;
+  } else {
+    info.node_entities_info_seq.clear();
+    info.filtered_out_entities.clear();
+    for (const auto & node_info : msg.node_entities_info_seq) {
+      if (!is_node_filtered_out(info, node_info)) {
+        info.node_entities_info_seq.push_back(node_info);
+      }
+    }
+  }
+  rmw_gid_t gid;
+  rmw_dds_common::convert_msg_to_gid(&msg.gid, &gid);
+  index_node_changes(gid, info, previous_nodes);
 }
 
 bool
-GraphCache::remove_entity(const rmw_gid_t & gid, bool is_reader)
+GraphCache::is_node_filtered_out(
+  ParticipantInfo & info,
+  const rmw_dds_common::msg::NodeEntitiesInfo & node_info)
 {
-  if (is_reader) {
-    return this->remove_reader(gid);
+  if (
+    ingest_filter_.node_namespace_prefixes.empty() ||
+    __starts_with_any(node_info.node_namespace, ingest_filter_.node_namespace_prefixes))
+  {
+    return false;
   }
-  return this->remove_writer(gid);
+  ingest_filter_stats_.node_namespace_hits++;
+  for (const auto & gid_msg : node_info.reader_gid_seq) {
+    rmw_gid_t entity_gid;
+    rmw_dds_common::convert_msg_to_gid(&gid_msg, &entity_gid);
+    index_entity_change(data_readers_, entity_gid, true);
+    data_readers_.erase(entity_gid);
+    info.filtered_out_entities.insert(entity_gid);
+  }
+  for (const auto & gid_msg : node_info.writer_gid_seq) {
+    rmw_gid_t entity_gid;
+    rmw_dds_common::convert_msg_to_gid(&gid_msg, &entity_gid);
+    index_entity_change(data_writers_, entity_gid, true);
+    data_writers_.erase(entity_gid);
+    info.filtered_out_entities.insert(entity_gid);
+  }
+  return true;
 }
 
 void
-GraphCache::update_participant_entities(const rmw_dds_common::msg::ParticipantEntitiesInfo & msg)
+GraphCache::update_node_entities(const rmw_dds_common::msg::ParticipantNodeEntitiesInfo & msg)
 {
   std::lock_guard<std::mutex> guard(mutex_);
   rmw_gid_t gid;
@@ -221,7 +1707,45 @@ GraphCache::update_participant_entities(const rmw_dds_common::msg::ParticipantEn
     it = ret.first;
     assert(ret.second);
   }
-  it->second.node_entities_info_seq = msg.node_entities_info_seq;
+  ParticipantInfo & info = it->second;
+  if (info.filtered_out) {
+    ingest_filter_stats_.enclave_hits++;
+    return;
+  }
+  info.has_ros_discovery_info = true;
+  info.is_bare_dds_participant = false;
+  rmw_dds_common::msg::NodeEntitiesInfo node_info;
+  node_info.node_namespace = msg.node_namespace;
+  node_info.node_name = msg.node_name;
+  node_info.reader_gid_seq = msg.reader_gid_seq;
+  node_info.writer_gid_seq = msg.writer_gid_seq;
+  auto & nodes = info.node_entities_info_seq;
+  auto node_it = std::find_if(
+    nodes.begin(),
+    nodes.end(),
+    [&](const rmw_dds_common::msg::NodeEntitiesInfo & elem)
+    {
+      return elem.node_name == node_info.node_name &&
+      elem.node_namespace == node_info.node_namespace;
+    });
+  if (msg.node_removed) {
+    if (nodes.end() == node_it) {
+      return;
+    }
+    index_node_change(gid, node_it->node_namespace, node_it->node_name, true);
+    nodes.erase(node_it);
+  } else if (is_node_filtered_out(info, node_info)) {
+    if (nodes.end() != node_it) {
+      index_node_change(gid, node_it->node_namespace, node_it->node_name, true);
+      nodes.erase(node_it);
+    }
+  } else if (nodes.end() == node_it) {
+    index_node_change(gid, node_info.node_namespace, node_info.node_name, false);
+    nodes.push_back(std::move(node_info));
+  } else {
+    index_node_change(gid, node_info.node_namespace, node_info.node_name, false);
+    *node_it = std::move(node_info);
+  }
   GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(this);
 }
 
@@ -229,23 +1753,17 @@ bool
 GraphCache::remove_participant(const rmw_gid_t & participant_gid)
 {
   std::lock_guard<std::mutex> guard(mutex_);
+  participants_with_pending_update_.erase(participant_gid);
+  provisional_participants_.erase(participant_gid);
+  index_participant_removal(participant_gid);
   bool ret = participants_.erase(participant_gid) > 0;
+  if (ret) {
+    record_churn(nullptr, participant_gid, false);
+  }
   GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK_IF(this, ret);
   return ret;
 }
 
-static
-rmw_dds_common::msg::ParticipantEntitiesInfo
-__create_participant_info_message(
-  const rmw_gid_t & gid,
-  const GraphCache::NodeEntitiesInfoSeq & info)
-{
-  rmw_dds_common::msg::ParticipantEntitiesInfo msg;
-  rmw_dds_common::convert_gid_to_msg(&gid, &msg.gid);
-  msg.node_entities_info_seq = info;
-  return msg;
-}
-
 void
 GraphCache::add_participant(
   const rmw_gid_t & participant_gid,
@@ -253,7 +1771,8 @@ GraphCache::add_participant(
 {
   std::lock_guard<std::mutex> guard(mutex_);
   auto it = participants_.find(participant_gid);
-  if (participants_.end() == it) {
+  const bool added = participants_.end() == it;
+  if (added) {
     auto ret = participants_.emplace(
       std::piecewise_construct,
       std::forward_as_tuple(participant_gid),
@@ -261,7 +1780,19 @@ GraphCache::add_participant(
     it = ret.first;
     assert(ret.second);
   }
+  provisional_participants_.erase(participant_gid);
   it->second.enclave = enclave;
+  it->second.filtered_out = __is_enclave_filtered_out(ingest_filter_, enclave);
+  if (it->second.filtered_out) {
+    ingest_filter_stats_.enclave_hits++;
+    index_participant_removal(participant_gid);
+    it->second.node_entities_info_seq.clear();
+    it->second.pending_update.reset();
+    participants_with_pending_update_.erase(participant_gid);
+    erase_participant_entities(participant_gid);
+  } else if (added) {
+    record_churn(nullptr, participant_gid, true);
+  }
   GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(this);
 }
 
@@ -281,6 +1812,8 @@ GraphCache::add_node(
   node_info.node_name = node_name;
   node_info.node_namespace = node_namespace;
   it->second.node_entities_info_seq.emplace_back(node_info);
+  it->second.has_ros_discovery_info = true;
+  index_node_change(participant_gid, node_info.node_namespace, node_info.node_name, false);
 
   GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(this);
   return __create_participant_info_message(participant_gid, it->second.node_entities_info_seq);
@@ -306,6 +1839,7 @@ GraphCache::remove_node(
 
   assert(to_remove != it->second.node_entities_info_seq.end());
 
+  index_node_change(participant_gid, to_remove->node_namespace, to_remove->node_name, true);
   it->second.node_entities_info_seq.erase(to_remove);
   GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(this);
 
@@ -353,6 +1887,7 @@ GraphCache::associate_writer(
     };
   auto msg = __modify_node_info(
     participant_gid, node_name, node_namespace, add_writer_gid, participants_);
+  index_node_change(participant_gid, node_namespace, node_name, false);
 
   GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(this);
   return msg;
@@ -383,6 +1918,7 @@ GraphCache::dissociate_writer(
     };
   auto msg = __modify_node_info(
     participant_gid, node_name, node_namespace, delete_writer_gid, participants_);
+  index_node_change(participant_gid, node_namespace, node_name, false);
 
   GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(this);
   return msg;
@@ -403,6 +1939,7 @@ GraphCache::associate_reader(
     };
   auto msg = __modify_node_info(
     participant_gid, node_name, node_namespace, add_reader_gid, participants_);
+  index_node_change(participant_gid, node_namespace, node_name, false);
 
   GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(this);
   return msg;
@@ -433,6 +1970,7 @@ GraphCache::dissociate_reader(
     };
   auto msg = __modify_node_info(
     participant_gid, node_name, node_namespace, delete_reader_gid, participants_);
+  index_node_change(participant_gid, node_namespace, node_name, false);
 
   GRAPH_CACHE_CALL_ON_CHANGE_CALLBACK(this);
   return msg;
@@ -447,12 +1985,13 @@ __get_count(
 {
   assert(count);
 
-  *count = std::count_if(
-    entities.begin(),
-    entities.end(),
-    [&topic_name](const GraphCache::EntityGidToInfo::value_type & elem)
+  *count = 0u;
+  entities.for_each(
+    [&topic_name, count](const rmw_gid_t &, const rmw_gid_t &, const EntityInfo & info)
     {
-      return elem.second.topic_name == topic_name;
+      if (info.topic_name == topic_name) {
+        (*count)++;
+      }
     });
   return RMW_RET_OK;
 }
@@ -536,20 +2075,26 @@ __get_entities_info_by_topic(
     return RMW_RET_OK;
   }
 
-  size_t size = std::count_if(
-    entities.begin(),
-    entities.end(),
-    [&topic_name](const GraphCache::EntityGidToInfo::value_type & item) {
-      return item.second.topic_name == topic_name;
-    }
-  );
-  if (0u == size) {
+  struct Endpoint
+  {
+    rmw_gid_t gid;
+    rmw_gid_t participant_gid;
+    const EntityInfo * info;
+  };
+  std::vector<Endpoint> endpoints;
+  entities.for_each(
+    [&](const rmw_gid_t & gid, const rmw_gid_t & participant_gid, const EntityInfo & info) {
+      if (info.topic_name == topic_name) {
+        endpoints.push_back({gid, participant_gid, &info});
+      }
+    });
+  if (endpoints.empty()) {
     return RMW_RET_OK;
   }
 
   rmw_ret_t ret = rmw_topic_endpoint_info_array_init_with_size(
     endpoints_info,
-    size,
+    endpoints.size(),
     allocator);
   if (RMW_RET_OK != ret) {
     return ret;
@@ -573,18 +2118,14 @@ __get_entities_info_by_topic(
   );
 
   size_t i = 0;
-  for (const auto & entity_pair : entities) {
-    if (entity_pair.second.topic_name != topic_name) {
-      continue;
-    }
-
+  for (const auto & endpoint : endpoints) {
     rmw_topic_endpoint_info_t & endpoint_info = endpoints_info->info_array[i];
     endpoint_info = rmw_get_zero_initialized_topic_endpoint_info();
 
     auto result = __find_name_and_namespace_from_entity_gid(
       participant_map,
-      entity_pair.second.participant_gid,
-      entity_pair.first,
+      endpoint.participant_gid,
+      endpoint.gid,
       is_reader);
 
     std::string node_name;
@@ -622,7 +2163,7 @@ __get_entities_info_by_topic(
 
     ret = rmw_topic_endpoint_info_set_topic_type(
       &endpoint_info,
-      demangle_type(entity_pair.second.topic_type).c_str(),
+      demangle_type(endpoint.info->topic_type).c_str(),
       allocator);
     if (RMW_RET_OK != ret) {
       return ret;
@@ -630,7 +2171,7 @@ __get_entities_info_by_topic(
 
     ret = rmw_topic_endpoint_info_set_topic_type_hash(
       &endpoint_info,
-      &entity_pair.second.topic_type_hash);
+      &endpoint.info->topic_type_hash);
     if (RMW_RET_OK != ret) {
       return ret;
     }
@@ -644,7 +2185,7 @@ __get_entities_info_by_topic(
 
     ret = rmw_topic_endpoint_info_set_gid(
       &endpoint_info,
-      entity_pair.first.data,
+      endpoint.gid.data,
       RMW_GID_STORAGE_SIZE);
     if (RMW_RET_OK != ret) {
       return ret;
@@ -652,7 +2193,7 @@ __get_entities_info_by_topic(
 
     ret = rmw_topic_endpoint_info_set_qos_profile(
       &endpoint_info,
-      &entity_pair.second.qos);
+      &endpoint.info->qos);
     if (RMW_RET_OK != ret) {
       return ret;
     }
@@ -699,6 +2240,62 @@ GraphCache::get_readers_info_by_topic(
     endpoints_info);
 }
 
+/// Summarize the QoS profiles of the endpoints on the topics in `summaries`.
+static
+void
+__summarize_qos_by_topic(
+  const GraphCache::EntityGidToInfo & entities,
+  std::map<std::string_view, rmw_dds_common::QosProfileSummary, std::less<>> & summaries)
+{
+  if (summaries.empty()) {
+    return;
+  }
+  entities.for_each(
+    [&summaries](const rmw_gid_t &, const rmw_gid_t &, const EntityInfo & info) {
+      auto it = summaries.find(info.topic_name);
+      if (summaries.end() != it) {
+        rmw_dds_common::qos_profile_summary_add(info.qos, it->second);
+      }
+    });
+}
+
+void
+GraphCache::resolve_best_available_qos(std::vector<BestAvailableQosRequest> & requests) const
+{
+  // Data readers are resolved against data writers, and the other way around.
+  std::map<std::string_view, rmw_dds_common::QosProfileSummary, std::less<>> writers_by_topic;
+  std::map<std::string_view, rmw_dds_common::QosProfileSummary, std::less<>> readers_by_topic;
+  for (const auto & request : requests) {
+    if (rmw_dds_common::qos_profile_has_best_available_policy(request.qos)) {
+      auto & summaries = request.is_reader ? writers_by_topic : readers_by_topic;
+      summaries.emplace(request.topic_name, rmw_dds_common::QosProfileSummary{});
+    }
+  }
+  if (writers_by_topic.empty() && readers_by_topic.empty()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    __summarize_qos_by_topic(data_writers_, writers_by_topic);
+    __summarize_qos_by_topic(data_readers_, readers_by_topic);
+  }
+
+  for (auto & request : requests) {
+    if (request.is_reader) {
+      auto it = writers_by_topic.find(request.topic_name);
+      if (writers_by_topic.end() != it) {
+        rmw_dds_common::qos_profile_get_best_available_for_subscription(it->second, &request.qos);
+      }
+    } else {
+      auto it = readers_by_topic.find(request.topic_name);
+      if (readers_by_topic.end() != it) {
+        rmw_dds_common::qos_profile_get_best_available_for_publisher(it->second, &request.qos);
+      }
+    }
+  }
+}
+
 using NamesAndTypes = std::map<std::string, std::set<std::string>>;
 
 static
@@ -711,12 +2308,13 @@ __get_names_and_types(
 {
   assert(nullptr != demangle_topic);
   assert(nullptr != demangle_type);
-  for (const auto & item : entities) {
-    std::string demangled_topic_name = demangle_topic(item.second.topic_name);
-    if ("" != demangled_topic_name) {
-      topics[demangled_topic_name].insert(demangle_type(item.second.topic_type));
-    }
-  }
+  entities.for_each(
+    [&](const rmw_gid_t &, const rmw_gid_t &, const EntityInfo & info) {
+      std::string demangled_topic_name = demangle_topic(info.topic_name);
+      if ("" != demangled_topic_name) {
+        topics[demangled_topic_name].insert(demangle_type(info.topic_type));
+      }
+    });
 }
 
 static
@@ -851,15 +2449,15 @@ __get_names_and_types_from_gids(
   for (const auto & gid_msg : gids) {
     rmw_gid_t gid;
     rmw_dds_common::convert_msg_to_gid(&gid_msg, &gid);
-    auto it = entities_map.find(gid);
-    if (it == entities_map.end()) {
+    const EntityInfo * info = entities_map.find(gid);
+    if (nullptr == info) {
       continue;
     }
-    std::string demangled_topic_name = demangle_topic(it->second.topic_name);
+    std::string demangled_topic_name = demangle_topic(info->topic_name);
     if ("" == demangled_topic_name) {
       continue;
     }
-    topics[demangled_topic_name].insert(demangle_type(it->second.topic_type));
+    topics[demangled_topic_name].insert(demangle_type(info->topic_type));
   }
   return topics;
 }
@@ -985,6 +2583,17 @@ GraphCache::get_number_of_nodes() const
   return __get_number_of_nodes(participants_);
 }
 
+rmw_dds_common::msg::ParticipantEntitiesInfo
+GraphCache::get_participant_entities_info(const rmw_gid_t & participant_gid) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = participants_.find(participant_gid);
+  if (participants_.end() == it) {
+    return __create_participant_info_message(participant_gid, {});
+  }
+  return __create_participant_info_message(participant_gid, it->second.node_entities_info_seq);
+}
+
 rmw_ret_t
 GraphCache::get_node_names(
   rcutils_string_array_t * node_names,
@@ -1095,17 +2704,15 @@ rmw_dds_common::operator<<(std::ostream & ostream, const GraphCache & graph_cach
   ss << "---------------------------------" << std::endl;
   ss << "Graph cache:" << std::endl;
   ss << "  Discovered data writers:" << std::endl;
-  for (const auto & data_writer_pair : graph_cache.data_writers_) {
-    ss << "    gid: '" << data_writer_pair.first << "', topic name: '" <<
-      data_writer_pair.second.topic_name << "', topic_type: '" <<
-      data_writer_pair.second.topic_type << "'" << std::endl;
-  }
+  auto print_entity =
+    [&ss](const rmw_gid_t & gid, const rmw_gid_t &, const EntityInfo & info) {
+      ss << "    gid: '" << gid << "', topic name: '" <<
+        info.topic_name << "', topic_type: '" <<
+        info.topic_type << "'" << std::endl;
+    };
+  graph_cache.data_writers_.for_each(print_entity);
   ss << "  Discovered data readers:" << std::endl;
-  for (const auto & data_reader_pair : graph_cache.data_readers_) {
-    ss << "    gid: '" << data_reader_pair.first << "', topic name: '" <<
-      data_reader_pair.second.topic_name << "', topic_type: '" <<
-      data_reader_pair.second.topic_type << "'" << std::endl;
-  }
+  graph_cache.data_readers_.for_each(print_entity);
   ss << "  Discovered participants:" << std::endl;
   for (const auto & item : graph_cache.participants_) {
     ss << "    gid: '" << item.first << std::endl;
@@ -0,0 +1,129 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_dds_common/local_entity_index.hpp"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rmw/types.h"
+
+using rmw_dds_common::LocalEntityIndex;
+using rmw_dds_common::LocalEntityInfo;
+
+bool
+LocalEntityIndex::add_entity(const LocalEntityInfo & info)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!entities_.emplace(info.gid, info).second) {
+    return false;
+  }
+  TopicCount & topic_count = topic_counts_[info.topic_name];
+  if (info.is_reader) {
+    topic_count.readers++;
+  } else {
+    topic_count.writers++;
+  }
+  return true;
+}
+
+bool
+LocalEntityIndex::remove_entity(const rmw_gid_t & gid)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = entities_.find(gid);
+  if (entities_.end() == it) {
+    return false;
+  }
+  auto topic_it = topic_counts_.find(it->second.topic_name);
+  if (topic_counts_.end() != topic_it) {
+    TopicCount & topic_count = topic_it->second;
+    if (it->second.is_reader) {
+      topic_count.readers--;
+    } else {
+      topic_count.writers--;
+    }
+    if (0u == topic_count.readers && 0u == topic_count.writers) {
+      topic_counts_.erase(topic_it);
+    }
+  }
+  entities_.erase(it);
+  return true;
+}
+
+rmw_ret_t
+LocalEntityIndex::get_writer_count(
+  const std::string & topic_name,
+  size_t * count) const
+{
+  if (!count) {
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = topic_counts_.find(topic_name);
+  *count = topic_counts_.end() == it ? 0u : it->second.writers;
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+LocalEntityIndex::get_reader_count(
+  const std::string & topic_name,
+  size_t * count) const
+{
+  if (!count) {
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = topic_counts_.find(topic_name);
+  *count = topic_counts_.end() == it ? 0u : it->second.readers;
+  return RMW_RET_OK;
+}
+
+std::vector<LocalEntityInfo>
+LocalEntityIndex::get_writers_by_node(
+  const std::string & node_name,
+  const std::string & node_namespace) const
+{
+  return this->get_entities_by_node(node_name, node_namespace, false);
+}
+
+std::vector<LocalEntityInfo>
+LocalEntityIndex::get_readers_by_node(
+  const std::string & node_name,
+  const std::string & node_namespace) const
+{
+  return this->get_entities_by_node(node_name, node_namespace, true);
+}
+
+std::vector<LocalEntityInfo>
+LocalEntityIndex::get_entities_by_node(
+  const std::string & node_name,
+  const std::string & node_namespace,
+  bool is_reader) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::vector<LocalEntityInfo> ret;
+  for (const auto & item : entities_) {
+    const LocalEntityInfo & info = item.second;
+    if (
+      info.is_reader == is_reader &&
+      info.node_name == node_name &&
+      info.node_namespace == node_namespace)
+    {
+      ret.push_back(info);
+    }
+  }
+  return ret;
+}
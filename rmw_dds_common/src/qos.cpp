@@ -102,291 +102,225 @@ qos_profile_check_compatible(
     return RMW_RET_INVALID_ARGUMENT;
   }
 
-  // Presume profiles are compatible until proven otherwise
-  *compatibility = RMW_QOS_COMPATIBILITY_OK;
+  const uint32_t incompatibilities =
+    qos_profile_get_incompatibilities(publisher_qos, subscription_qos);
+  if (0u != (incompatibilities & qos_errors_mask)) {
+    *compatibility = RMW_QOS_COMPATIBILITY_ERROR;
+  } else if (0u != incompatibilities) {
+    *compatibility = RMW_QOS_COMPATIBILITY_WARNING;
+  } else {
+    *compatibility = RMW_QOS_COMPATIBILITY_OK;
+  }
 
   // Initialize reason buffer
-  if (reason && reason_size != 0u) {
-    reason[0] = '\0';
+  if (!reason || reason_size == 0u) {
+    return RMW_RET_OK;
   }
+  reason[0] = '\0';
 
-  // Best effort publisher and reliable subscription
-  if (publisher_qos.reliability == RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT &&
-    subscription_qos.reliability == RMW_QOS_POLICY_RELIABILITY_RELIABLE)
+  static const struct
   {
-    *compatibility = RMW_QOS_COMPATIBILITY_ERROR;
+    uint32_t incompatibility;
+    const char * reason;
+  } errors[] = {
+    {QOS_ERROR_RELIABILITY, "ERROR: Best effort publisher and reliable subscription;"},
+    {QOS_ERROR_DURABILITY, "ERROR: Volatile publisher and transient local subscription;"},
+    {QOS_ERROR_DEADLINE_MISSING, "ERROR: Subscription has a deadline, but publisher does not;"},
+    {QOS_ERROR_DEADLINE, "ERROR: Subscription deadline is less than publisher deadline;"},
+    {
+      QOS_ERROR_LIVELINESS,
+      "ERROR: Publisher's liveliness is automatic and subscription's is manual by topic;"
+    },
+    {
+      QOS_ERROR_LEASE_DURATION_MISSING,
+      "ERROR: Subscription has a liveliness lease duration, but publisher does not;"
+    },
+    {
+      QOS_ERROR_LEASE_DURATION,
+      "ERROR: Subscription liveliness lease duration is less than publisher;"
+    },
+  };
+  for (const auto & error : errors) {
+    if (0u != (incompatibilities & error.incompatibility)) {
+      rmw_ret_t append_ret = _append_to_buffer(reason, reason_size, "%s", error.reason);
+      if (RMW_RET_OK != append_ret) {
+        return append_ret;
+      }
+    }
+  }
+  if (RMW_QOS_COMPATIBILITY_WARNING != *compatibility) {
+    return RMW_RET_OK;
+  }
+
+  const char * pub_reliability_str = rmw_qos_reliability_policy_to_str(publisher_qos.reliability);
+  if (!pub_reliability_str) {
+    pub_reliability_str = "unknown";
+  }
+  const char * sub_reliability_str = rmw_qos_reliability_policy_to_str(
+    subscription_qos.reliability);
+  if (!sub_reliability_str) {
+    sub_reliability_str = "unknown";
+  }
+  const char * pub_durability_str = rmw_qos_durability_policy_to_str(publisher_qos.durability);
+  if (!pub_durability_str) {
+    pub_durability_str = "unknown";
+  }
+  const char * sub_durability_str = rmw_qos_durability_policy_to_str(subscription_qos.durability);
+  if (!sub_durability_str) {
+    sub_durability_str = "unknown";
+  }
+  const char * pub_liveliness_str = rmw_qos_liveliness_policy_to_str(publisher_qos.liveliness);
+  if (!pub_liveliness_str) {
+    pub_liveliness_str = "unknown";
+  }
+  const char * sub_liveliness_str = rmw_qos_liveliness_policy_to_str(subscription_qos.liveliness);
+  if (!sub_liveliness_str) {
+    sub_liveliness_str = "unknown";
+  }
+
+  // Reliability warnings
+  if (0u != (incompatibilities & QOS_WARNING_RELIABILITY_UNKNOWN)) {
     rmw_ret_t append_ret = _append_to_buffer(
       reason,
       reason_size,
-      "ERROR: Best effort publisher and reliable subscription;");
+      "WARNING: Publisher reliability is %s and subscription reliability is %s;",
+      pub_reliability_str,
+      sub_reliability_str);
     if (RMW_RET_OK != append_ret) {
       return append_ret;
     }
   }
-
-  // Volatile publisher and transient local subscription
-  if (publisher_qos.durability == RMW_QOS_POLICY_DURABILITY_VOLATILE &&
-    subscription_qos.durability == RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL)
-  {
-    *compatibility = RMW_QOS_COMPATIBILITY_ERROR;
+  if (0u != (incompatibilities & QOS_WARNING_PUBLISHER_RELIABILITY_UNKNOWN)) {
     rmw_ret_t append_ret = _append_to_buffer(
       reason,
       reason_size,
-      "ERROR: Volatile publisher and transient local subscription;");
+      "WARNING: Reliable subscription, but publisher is %s;",
+      pub_reliability_str);
     if (RMW_RET_OK != append_ret) {
       return append_ret;
     }
   }
-
-  const rmw_time_t & pub_deadline = publisher_qos.deadline;
-  const rmw_time_t & sub_deadline = subscription_qos.deadline;
-
-  // No deadline for publisher and deadline for subscription
-  if (pub_deadline == deadline_default && sub_deadline != deadline_default) {
-    *compatibility = RMW_QOS_COMPATIBILITY_ERROR;
-    rmw_ret_t ret = _append_to_buffer(
+  if (0u != (incompatibilities & QOS_WARNING_SUBSCRIPTION_RELIABILITY_UNKNOWN)) {
+    rmw_ret_t append_ret = _append_to_buffer(
       reason,
       reason_size,
-      "ERROR: Subscription has a deadline, but publisher does not;");
-    if (RMW_RET_OK != ret) {
-      return ret;
+      "WARNING: Best effort publisher, but subscription is %s;",
+      sub_reliability_str);
+    if (RMW_RET_OK != append_ret) {
+      return append_ret;
     }
   }
 
-  // Subscription deadline is less than publisher deadline
-  if (pub_deadline != deadline_default && sub_deadline != deadline_default) {
-    if (sub_deadline < pub_deadline) {
-      *compatibility = RMW_QOS_COMPATIBILITY_ERROR;
-      rmw_ret_t append_ret = _append_to_buffer(
-        reason,
-        reason_size,
-        "ERROR: Subscription deadline is less than publisher deadline;");
-      if (RMW_RET_OK != append_ret) {
-        return append_ret;
-      }
+  // Durability warnings
+  if (0u != (incompatibilities & QOS_WARNING_DURABILITY_UNKNOWN)) {
+    rmw_ret_t append_ret = _append_to_buffer(
+      reason,
+      reason_size,
+      "WARNING: Publisher durabilty is %s and subscription durability is %s;",
+      pub_durability_str,
+      sub_durability_str);
+    if (RMW_RET_OK != append_ret) {
+      return append_ret;
     }
   }
-
-  // Automatic liveliness for publisher and manual by topic for subscription
-  if (publisher_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_AUTOMATIC &&
-    subscription_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC)
-  {
-    *compatibility = RMW_QOS_COMPATIBILITY_ERROR;
+  if (0u != (incompatibilities & QOS_WARNING_PUBLISHER_DURABILITY_UNKNOWN)) {
     rmw_ret_t append_ret = _append_to_buffer(
       reason,
       reason_size,
-      "ERROR: Publisher's liveliness is automatic and subscription's is manual by topic;");
+      "WARNING: Transient local subscription, but publisher is %s;",
+      pub_durability_str);
     if (RMW_RET_OK != append_ret) {
       return append_ret;
     }
   }
-
-  const rmw_time_t & pub_lease = publisher_qos.liveliness_lease_duration;
-  const rmw_time_t & sub_lease = subscription_qos.liveliness_lease_duration;
-
-  // No lease duration for publisher and lease duration for subscription
-  if (pub_lease == liveliness_lease_duration_default &&
-    sub_lease != liveliness_lease_duration_default)
-  {
-    *compatibility = RMW_QOS_COMPATIBILITY_ERROR;
+  if (0u != (incompatibilities & QOS_WARNING_SUBSCRIPTION_DURABILITY_UNKNOWN)) {
     rmw_ret_t append_ret = _append_to_buffer(
       reason,
       reason_size,
-      "ERROR: Subscription has a liveliness lease duration, but publisher does not;");
+      "WARNING: Volatile publisher, but subscription is %s;",
+      sub_durability_str);
     if (RMW_RET_OK != append_ret) {
       return append_ret;
     }
   }
 
-  // Subscription lease duration is less than publisher lease duration
-  if (pub_lease != liveliness_lease_duration_default &&
-    sub_lease != liveliness_lease_duration_default)
-  {
-    if (sub_lease < pub_lease) {
-      *compatibility = RMW_QOS_COMPATIBILITY_ERROR;
-      rmw_ret_t append_ret = _append_to_buffer(
-        reason,
-        reason_size,
-        "ERROR: Subscription liveliness lease duration is less than publisher;");
-      if (RMW_RET_OK != append_ret) {
-        return append_ret;
-      }
+  // Liveliness warnings
+  if (0u != (incompatibilities & QOS_WARNING_LIVELINESS_UNKNOWN)) {
+    rmw_ret_t append_ret = _append_to_buffer(
+      reason,
+      reason_size,
+      "WARNING: Publisher liveliness is %s and subscription liveliness is %s;",
+      pub_liveliness_str,
+      sub_liveliness_str);
+    if (RMW_RET_OK != append_ret) {
+      return append_ret;
     }
   }
-
-  // Only check for warnings if there are no errors
-  if (RMW_QOS_COMPATIBILITY_OK == *compatibility) {
-    // We don't know the policy if the value is "system default" or "unknown"
-    const bool pub_reliability_unknown =
-      publisher_qos.reliability == RMW_QOS_POLICY_RELIABILITY_SYSTEM_DEFAULT ||
-      publisher_qos.reliability == RMW_QOS_POLICY_RELIABILITY_UNKNOWN;
-    const bool sub_reliability_unknown =
-      subscription_qos.reliability == RMW_QOS_POLICY_RELIABILITY_SYSTEM_DEFAULT ||
-      subscription_qos.reliability == RMW_QOS_POLICY_RELIABILITY_UNKNOWN;
-    const bool pub_durability_unknown =
-      publisher_qos.durability == RMW_QOS_POLICY_DURABILITY_SYSTEM_DEFAULT ||
-      publisher_qos.durability == RMW_QOS_POLICY_DURABILITY_UNKNOWN;
-    const bool sub_durability_unknown =
-      subscription_qos.durability == RMW_QOS_POLICY_DURABILITY_SYSTEM_DEFAULT ||
-      subscription_qos.durability == RMW_QOS_POLICY_DURABILITY_UNKNOWN;
-    const bool pub_liveliness_unknown =
-      publisher_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_SYSTEM_DEFAULT ||
-      publisher_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_UNKNOWN;
-    const bool sub_liveliness_unknown =
-      subscription_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_SYSTEM_DEFAULT ||
-      subscription_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_UNKNOWN;
-
-    const char * pub_reliability_str = rmw_qos_reliability_policy_to_str(publisher_qos.reliability);
-    if (!pub_reliability_str) {
-      pub_reliability_str = "unknown";
-    }
-    const char * sub_reliability_str = rmw_qos_reliability_policy_to_str(
-      subscription_qos.reliability);
-    if (!sub_reliability_str) {
-      sub_reliability_str = "unknown";
-    }
-    const char * pub_durability_str = rmw_qos_durability_policy_to_str(publisher_qos.durability);
-    if (!pub_durability_str) {
-      pub_durability_str = "unknown";
-    }
-    const char * sub_durability_str = rmw_qos_durability_policy_to_str(subscription_qos.durability);
-    if (!sub_durability_str) {
-      sub_durability_str = "unknown";
-    }
-    const char * pub_liveliness_str = rmw_qos_liveliness_policy_to_str(publisher_qos.liveliness);
-    if (!pub_liveliness_str) {
-      pub_liveliness_str = "unknown";
+  if (0u != (incompatibilities & QOS_WARNING_PUBLISHER_LIVELINESS_UNKNOWN)) {
+    rmw_ret_t append_ret = _append_to_buffer(
+      reason,
+      reason_size,
+      "WARNING: Subscription's liveliness is manual by topic, but publisher's is %s;",
+      pub_liveliness_str);
+    if (RMW_RET_OK != append_ret) {
+      return append_ret;
     }
-    const char * sub_liveliness_str = rmw_qos_liveliness_policy_to_str(subscription_qos.liveliness);
-    if (!sub_liveliness_str) {
-      sub_liveliness_str = "unknown";
+  }
+  if (0u != (incompatibilities & QOS_WARNING_SUBSCRIPTION_LIVELINESS_UNKNOWN)) {
+    rmw_ret_t append_ret = _append_to_buffer(
+      reason,
+      reason_size,
+      "WARNING: Publisher's liveliness is automatic, but subscription's is %s;",
+      sub_liveliness_str);
+    if (RMW_RET_OK != append_ret) {
+      return append_ret;
     }
+  }
 
-    // Reliability warnings
-    if (pub_reliability_unknown && sub_reliability_unknown) {
-      // Reliability for publisher and subscription is unknown
-      *compatibility = RMW_QOS_COMPATIBILITY_WARNING;
-      rmw_ret_t append_ret = _append_to_buffer(
-        reason,
-        reason_size,
-        "WARNING: Publisher reliability is %s and subscription reliability is %s;",
-        pub_reliability_str,
-        sub_reliability_str);
-      if (RMW_RET_OK != append_ret) {
-        return append_ret;
-      }
-    } else if (pub_reliability_unknown &&  // NOLINT
-      subscription_qos.reliability == RMW_QOS_POLICY_RELIABILITY_RELIABLE)
-    {
-      // Reliability for publisher is unknown and subscription is reliable
-      *compatibility = RMW_QOS_COMPATIBILITY_WARNING;
-      rmw_ret_t append_ret = _append_to_buffer(
-        reason,
-        reason_size,
-        "WARNING: Reliable subscription, but publisher is %s;",
-        pub_reliability_str);
-      if (RMW_RET_OK != append_ret) {
-        return append_ret;
-      }
-    } else if (publisher_qos.reliability == RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT &&  // NOLINT
-      sub_reliability_unknown)
-    {
-      // Reliability for publisher is best effort and subscription is unknown
-      *compatibility = RMW_QOS_COMPATIBILITY_WARNING;
-      rmw_ret_t append_ret = _append_to_buffer(
-        reason,
-        reason_size,
-        "WARNING: Best effort publisher, but subscription is %s;",
-        sub_reliability_str);
-      if (RMW_RET_OK != append_ret) {
-        return append_ret;
-      }
-    }
+  return RMW_RET_OK;
+}
 
-    // Durability warnings
-    if (pub_durability_unknown && sub_durability_unknown) {
-      // Durability for publisher and subscription is unknown
-      *compatibility = RMW_QOS_COMPATIBILITY_WARNING;
-      rmw_ret_t append_ret = _append_to_buffer(
-        reason,
-        reason_size,
-        "WARNING: Publisher durabilty is %s and subscription durability is %s;",
-        pub_durability_str,
-        sub_durability_str);
-      if (RMW_RET_OK != append_ret) {
-        return append_ret;
-      }
-    } else if (pub_durability_unknown &&  // NOLINT
-      subscription_qos.durability == RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL)
-    {
-      // Durability for publisher is unknown and subscription is transient local
-      *compatibility = RMW_QOS_COMPATIBILITY_WARNING;
-      rmw_ret_t ret = _append_to_buffer(
-        reason,
-        reason_size,
-        "WARNING: Transient local subscription, but publisher is %s;",
-        pub_durability_str);
-      if (RMW_RET_OK != ret) {
-        return ret;
-      }
-    } else if (publisher_qos.durability == RMW_QOS_POLICY_DURABILITY_VOLATILE &&  // NOLINT
-      sub_durability_unknown)
-    {
-      // Durability for publisher is volatile and subscription is unknown
-      *compatibility = RMW_QOS_COMPATIBILITY_WARNING;
-      rmw_ret_t ret = _append_to_buffer(
-        reason,
-        reason_size,
-        "WARNING: Volatile publisher, but subscription is %s;",
-        sub_durability_str);
-      if (RMW_RET_OK != ret) {
-        return ret;
-      }
+void
+qos_profile_summary_add(const rmw_qos_profile_t & profile, QosProfileSummary & summary)
+{
+  summary.count++;
+  if (RMW_QOS_POLICY_RELIABILITY_RELIABLE == profile.reliability) {
+    summary.reliable++;
+  }
+  if (RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL == profile.durability) {
+    summary.transient_local++;
+  }
+  if (RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC == profile.liveliness) {
+    summary.manual_by_topic++;
+  }
+  if (profile.deadline != deadline_default) {
+    summary.default_deadline = false;
+    if (summary.largest_deadline < profile.deadline) {
+      summary.largest_deadline = profile.deadline;
     }
-
-    // Liveliness warnings
-    if (pub_liveliness_unknown && sub_liveliness_unknown) {
-      // Liveliness for publisher and subscription is unknown
-      *compatibility = RMW_QOS_COMPATIBILITY_WARNING;
-      rmw_ret_t append_ret = _append_to_buffer(
-        reason,
-        reason_size,
-        "WARNING: Publisher liveliness is %s and subscription liveliness is %s;",
-        pub_liveliness_str,
-        sub_liveliness_str);
-      if (RMW_RET_OK != append_ret) {
-        return append_ret;
-      }
-    } else if (pub_liveliness_unknown &&  // NOLINT
-      subscription_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC)
-    {
-      // Unknown liveliness for publisher and manual by topic for subscription
-      *compatibility = RMW_QOS_COMPATIBILITY_WARNING;
-      rmw_ret_t ret = _append_to_buffer(
-        reason,
-        reason_size,
-        "WARNING: Subscription's liveliness is manual by topic, but publisher's is %s;",
-        pub_liveliness_str);
-      if (RMW_RET_OK != ret) {
-        return ret;
-      }
-    } else if (publisher_qos.liveliness == RMW_QOS_POLICY_LIVELINESS_AUTOMATIC &&  // NOLINT
-      sub_liveliness_unknown)
-    {
-      // Automatic liveliness for publisher and unknown for subscription
-      *compatibility = RMW_QOS_COMPATIBILITY_WARNING;
-      rmw_ret_t ret = _append_to_buffer(
-        reason,
-        reason_size,
-        "WARNING: Publisher's liveliness is automatic, but subscription's is %s;",
-        sub_liveliness_str);
-      if (RMW_RET_OK != ret) {
-        return ret;
-      }
+    if (profile.deadline < summary.smallest_deadline) {
+      summary.smallest_deadline = profile.deadline;
     }
   }
+  if (profile.liveliness_lease_duration != liveliness_lease_duration_default) {
+    summary.default_liveliness_lease_duration = false;
+    if (summary.largest_liveliness_lease_duration < profile.liveliness_lease_duration) {
+      summary.largest_liveliness_lease_duration = profile.liveliness_lease_duration;
+    }
+    if (profile.liveliness_lease_duration < summary.smallest_liveliness_lease_duration) {
+      summary.smallest_liveliness_lease_duration = profile.liveliness_lease_duration;
+    }
+  }
+}
 
-  return RMW_RET_OK;
+static QosProfileSummary
+_summarize_endpoints_info(const rmw_topic_endpoint_info_array_t & endpoints_info)
+{
+  QosProfileSummary summary;
+  for (size_t i = 0u; i < endpoints_info.size; ++i) {
+    qos_profile_summary_add(endpoints_info.info_array[i].qos_profile, summary);
+  }
+  return summary;
 }
 
 rmw_ret_t
@@ -398,6 +332,15 @@ qos_profile_get_best_available_for_subscription(
     RMW_SET_ERROR_MSG("publishers_info parameter is null");
     return RMW_RET_INVALID_ARGUMENT;
   }
+  return qos_profile_get_best_available_for_subscription(
+    _summarize_endpoints_info(*publishers_info), subscription_profile);
+}
+
+rmw_ret_t
+qos_profile_get_best_available_for_subscription(
+  const QosProfileSummary & publishers_summary,
+  rmw_qos_profile_t * subscription_profile)
+{
   if (!subscription_profile) {
     RMW_SET_ERROR_MSG("subscription_profile parameter is null");
     return RMW_RET_INVALID_ARGUMENT;
@@ -408,40 +351,8 @@ qos_profile_get_best_available_for_subscription(
   // Only use "manual by topic" liveliness if all publisher profiles are manual by topic
   // Use default deadline if all publishers have default deadline, otherwise use largest deadline
   // Use default lease duration if all publishers have default lease, otherwise use largest lease
-  size_t number_of_reliable = 0u;
-  size_t number_of_transient_local = 0u;
-  size_t number_of_manual_by_topic = 0u;
-  bool use_default_deadline = true;
-  rmw_time_t largest_deadline = {0u, 0u};
-  bool use_default_liveliness_lease_duration = true;
-  rmw_time_t largest_liveliness_lease_duration = {0u, 0u};
-  for (size_t i = 0u; i < publishers_info->size; ++i) {
-    const rmw_qos_profile_t & profile = publishers_info->info_array[i].qos_profile;
-    if (RMW_QOS_POLICY_RELIABILITY_RELIABLE == profile.reliability) {
-      number_of_reliable++;
-    }
-    if (RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL == profile.durability) {
-      number_of_transient_local++;
-    }
-    if (RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC == profile.liveliness) {
-      number_of_manual_by_topic++;
-    }
-    if (profile.deadline != deadline_default) {
-      use_default_deadline = false;
-      if (largest_deadline < profile.deadline) {
-        largest_deadline = profile.deadline;
-      }
-    }
-    if (profile.liveliness_lease_duration != liveliness_lease_duration_default) {
-      use_default_liveliness_lease_duration = false;
-      if (largest_liveliness_lease_duration < profile.liveliness_lease_duration) {
-        largest_liveliness_lease_duration = profile.liveliness_lease_duration;
-      }
-    }
-  }
-
   if (RMW_QOS_POLICY_RELIABILITY_BEST_AVAILABLE == subscription_profile->reliability) {
-    if (number_of_reliable == publishers_info->size) {
+    if (publishers_summary.reliable == publishers_summary.count) {
       subscription_profile->reliability = RMW_QOS_POLICY_RELIABILITY_RELIABLE;
     } else {
       subscription_profile->reliability = RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT;
@@ -449,7 +360,7 @@ qos_profile_get_best_available_for_subscription(
   }
 
   if (RMW_QOS_POLICY_DURABILITY_BEST_AVAILABLE == subscription_profile->durability) {
-    if (number_of_transient_local == publishers_info->size) {
+    if (publishers_summary.transient_local == publishers_summary.count) {
       subscription_profile->durability = RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL;
     } else {
       subscription_profile->durability = RMW_QOS_POLICY_DURABILITY_VOLATILE;
@@ -457,7 +368,7 @@ qos_profile_get_best_available_for_subscription(
   }
 
   if (RMW_QOS_POLICY_LIVELINESS_BEST_AVAILABLE == subscription_profile->liveliness) {
-    if (number_of_manual_by_topic == publishers_info->size) {
+    if (publishers_summary.manual_by_topic == publishers_summary.count) {
       subscription_profile->liveliness = RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC;
     } else {
       subscription_profile->liveliness = RMW_QOS_POLICY_LIVELINESS_AUTOMATIC;
@@ -465,18 +376,19 @@ qos_profile_get_best_available_for_subscription(
   }
 
   if (deadline_best_available == subscription_profile->deadline) {
-    if (use_default_deadline) {
+    if (publishers_summary.default_deadline) {
       subscription_profile->deadline = RMW_QOS_DEADLINE_DEFAULT;
     } else {
-      subscription_profile->deadline = largest_deadline;
+      subscription_profile->deadline = publishers_summary.largest_deadline;
     }
   }
 
   if (liveliness_lease_duration_best_available == subscription_profile->liveliness_lease_duration) {
-    if (use_default_liveliness_lease_duration) {
+    if (publishers_summary.default_liveliness_lease_duration) {
       subscription_profile->liveliness_lease_duration = RMW_QOS_LIVELINESS_LEASE_DURATION_DEFAULT;
     } else {
-      subscription_profile->liveliness_lease_duration = largest_liveliness_lease_duration;
+      subscription_profile->liveliness_lease_duration =
+        publishers_summary.largest_liveliness_lease_duration;
     }
   }
 
@@ -492,6 +404,15 @@ qos_profile_get_best_available_for_publisher(
     RMW_SET_ERROR_MSG("subscriptions_info parameter is null");
     return RMW_RET_INVALID_ARGUMENT;
   }
+  return qos_profile_get_best_available_for_publisher(
+    _summarize_endpoints_info(*subscriptions_info), publisher_profile);
+}
+
+rmw_ret_t
+qos_profile_get_best_available_for_publisher(
+  const QosProfileSummary & subscriptions_summary,
+  rmw_qos_profile_t * publisher_profile)
+{
   if (!publisher_profile) {
     RMW_SET_ERROR_MSG("publisher_profile parameter is null");
     return RMW_RET_INVALID_ARGUMENT;
@@ -509,32 +430,8 @@ qos_profile_get_best_available_for_publisher(
   // Only use "manual by topic" liveliness if at least one  subscription is using manual by topic
   // Use default deadline if all subscriptions have default deadline, otherwise use smallest
   // Use default lease duration if all subscriptions have default lease, otherwise use smallest
-  bool use_manual_by_topic = false;
-  bool use_default_deadline = true;
-  rmw_time_t smallest_deadline = RMW_DURATION_INFINITE;
-  bool use_default_liveliness_lease_duration = true;
-  rmw_time_t smallest_liveliness_lease_duration = RMW_DURATION_INFINITE;
-  for (size_t i = 0u; i < subscriptions_info->size; ++i) {
-    const rmw_qos_profile_t & profile = subscriptions_info->info_array[i].qos_profile;
-    if (RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC == profile.liveliness) {
-      use_manual_by_topic = true;
-    }
-    if (profile.deadline != deadline_default) {
-      use_default_deadline = false;
-      if (profile.deadline < smallest_deadline) {
-        smallest_deadline = profile.deadline;
-      }
-    }
-    if (profile.liveliness_lease_duration != liveliness_lease_duration_default) {
-      use_default_liveliness_lease_duration = false;
-      if (profile.liveliness_lease_duration < smallest_liveliness_lease_duration) {
-        smallest_liveliness_lease_duration = profile.liveliness_lease_duration;
-      }
-    }
-  }
-
   if (RMW_QOS_POLICY_LIVELINESS_BEST_AVAILABLE == publisher_profile->liveliness) {
-    if (use_manual_by_topic) {
+    if (subscriptions_summary.manual_by_topic > 0u) {
       publisher_profile->liveliness = RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC;
     } else {
       publisher_profile->liveliness = RMW_QOS_POLICY_LIVELINESS_AUTOMATIC;
@@ -542,26 +439,27 @@ qos_profile_get_best_available_for_publisher(
   }
 
   if (deadline_best_available == publisher_profile->deadline) {
-    if (use_default_deadline) {
+    if (subscriptions_summary.default_deadline) {
       publisher_profile->deadline = RMW_QOS_DEADLINE_DEFAULT;
     } else {
-      publisher_profile->deadline = smallest_deadline;
+      publisher_profile->deadline = subscriptions_summary.smallest_deadline;
     }
   }
 
   if (liveliness_lease_duration_best_available == publisher_profile->liveliness_lease_duration) {
-    if (use_default_liveliness_lease_duration) {
+    if (subscriptions_summary.default_liveliness_lease_duration) {
       publisher_profile->liveliness_lease_duration = RMW_QOS_LIVELINESS_LEASE_DURATION_DEFAULT;
     } else {
-      publisher_profile->liveliness_lease_duration = smallest_liveliness_lease_duration;
+      publisher_profile->liveliness_lease_duration =
+        subscriptions_summary.smallest_liveliness_lease_duration;
     }
   }
 
   return RMW_RET_OK;
 }
 
-static bool
-_qos_profile_has_best_available_policy(const rmw_qos_profile_t & qos_profile)
+bool
+qos_profile_has_best_available_policy(const rmw_qos_profile_t & qos_profile)
 {
   if (RMW_QOS_POLICY_RELIABILITY_BEST_AVAILABLE == qos_profile.reliability) {
     return true;
@@ -592,7 +490,7 @@ qos_profile_get_best_available_for_topic_subscription(
   RMW_CHECK_ARGUMENT_FOR_NULL(topic_name, RMW_RET_INVALID_ARGUMENT);
   RMW_CHECK_ARGUMENT_FOR_NULL(qos_profile, RMW_RET_INVALID_ARGUMENT);
 
-  if (_qos_profile_has_best_available_policy(*qos_profile)) {
+  if (qos_profile_has_best_available_policy(*qos_profile)) {
     rcutils_allocator_t & allocator = node->context->options.allocator;
     rmw_topic_endpoint_info_array_t publishers_info =
       rmw_get_zero_initialized_topic_endpoint_info_array();
@@ -625,7 +523,7 @@ qos_profile_get_best_available_for_topic_publisher(
   RMW_CHECK_ARGUMENT_FOR_NULL(topic_name, RMW_RET_INVALID_ARGUMENT);
   RMW_CHECK_ARGUMENT_FOR_NULL(qos_profile, RMW_RET_INVALID_ARGUMENT);
 
-  if (_qos_profile_has_best_available_policy(*qos_profile)) {
+  if (qos_profile_has_best_available_policy(*qos_profile)) {
     rcutils_allocator_t & allocator = node->context->options.allocator;
     rmw_topic_endpoint_info_array_t subscriptions_info =
       rmw_get_zero_initialized_topic_endpoint_info_array();
@@ -650,23 +548,7 @@ qos_profile_get_best_available_for_topic_publisher(
 rmw_qos_profile_t
 qos_profile_update_best_available_for_services(const rmw_qos_profile_t & qos_profile)
 {
-  rmw_qos_profile_t result = qos_profile;
-  if (RMW_QOS_POLICY_RELIABILITY_BEST_AVAILABLE == result.reliability) {
-    result.reliability = rmw_qos_profile_services_default.reliability;
-  }
-  if (RMW_QOS_POLICY_DURABILITY_BEST_AVAILABLE == result.durability) {
-    result.durability = rmw_qos_profile_services_default.durability;
-  }
-  if (RMW_QOS_POLICY_LIVELINESS_BEST_AVAILABLE == result.liveliness) {
-    result.liveliness = rmw_qos_profile_services_default.liveliness;
-  }
-  if (deadline_best_available == result.deadline) {
-    result.deadline = rmw_qos_profile_services_default.deadline;
-  }
-  if (liveliness_lease_duration_best_available == result.liveliness_lease_duration) {
-    result.liveliness_lease_duration = rmw_qos_profile_services_default.liveliness_lease_duration;
-  }
-  return result;
+  return qos_profile_resolve_best_available_for_services(qos_profile);
 }
 
 rmw_ret_t
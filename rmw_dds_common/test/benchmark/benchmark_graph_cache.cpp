@@ -23,6 +23,7 @@
 
 #include "rmw_dds_common/gid_utils.hpp"
 #include "rmw_dds_common/graph_cache.hpp"
+#include "rmw_dds_common/qos.hpp"
 
 #include "rosidl_runtime_c/type_hash.h"
 
@@ -418,3 +419,82 @@ BENCHMARK_F(TestGraphCache, associate_entities_benchmark)(benchmark::State & st)
     });
   }
 }
+
+class TestGraphCacheBestAvailable : public PerformanceTest
+{
+public:
+  static constexpr size_t topic_count = 50u;
+
+  void SetUp(benchmark::State & st)
+  {
+    add_participants(graph_cache, {"participant1"});
+    for (size_t i = 0u; i < topic_count; i++) {
+      const std::string topic_name = "topic" + std::to_string(i);
+      entities.push_back({"reader" + std::to_string(i), "participant1", topic_name, "Str", true});
+      entities.push_back({"writer" + std::to_string(i), "participant1", topic_name, "Str", false});
+      // Requests as made by a component loading a plugin.
+      requests.push_back({topic_name, true, rmw_qos_profile_best_available});
+      requests.push_back({topic_name, false, rmw_qos_profile_best_available});
+    }
+    add_entities(graph_cache, entities);
+    performance_test_fixture::PerformanceTest::SetUp(st);
+  }
+  void TearDown(::benchmark::State & st)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(st);
+    remove_entities(graph_cache, entities);
+    remove_participants(graph_cache, {"participant1"});
+    entities.clear();
+    requests.clear();
+  }
+
+protected:
+  GraphCache graph_cache;
+  std::vector<EntityInfo> entities;
+  std::vector<GraphCache::BestAvailableQosRequest> requests;
+};
+
+BENCHMARK_F(TestGraphCacheBestAvailable, resolve_best_available_per_topic)(benchmark::State & st)
+{
+  rcutils_allocator_t allocator = rcutils_get_default_allocator();
+
+  for (auto _ : st) {
+    RCUTILS_UNUSED(_);
+    for (const auto & request : requests) {
+      rmw_qos_profile_t qos = request.qos;
+      rmw_topic_endpoint_info_array_t info = rmw_get_zero_initialized_topic_endpoint_info_array();
+      rmw_ret_t ret;
+      if (request.is_reader) {
+        ret = graph_cache.get_writers_info_by_topic(
+          request.topic_name, identity_demangle, &allocator, &info);
+        if (ret == RMW_RET_OK) {
+          ret = rmw_dds_common::qos_profile_get_best_available_for_subscription(&info, &qos);
+        }
+      } else {
+        ret = graph_cache.get_readers_info_by_topic(
+          request.topic_name, identity_demangle, &allocator, &info);
+        if (ret == RMW_RET_OK) {
+          ret = rmw_dds_common::qos_profile_get_best_available_for_publisher(&info, &qos);
+        }
+      }
+      if (ret != RMW_RET_OK) {
+        st.SkipWithError("best available resolution failed");
+      }
+      ret = rmw_topic_endpoint_info_array_fini(&info, &allocator);
+      if (ret != RMW_RET_OK) {
+        st.SkipWithError("rmw_topic_endpoint_info_array_fini failed");
+      }
+      benchmark::DoNotOptimize(qos);
+    }
+  }
+}
+
+BENCHMARK_F(TestGraphCacheBestAvailable, resolve_best_available_bulk)(benchmark::State & st)
+{
+  for (auto _ : st) {
+    RCUTILS_UNUSED(_);
+    std::vector<GraphCache::BestAvailableQosRequest> resolved = requests;
+    graph_cache.resolve_best_available_qos(resolved);
+    benchmark::DoNotOptimize(resolved.data());
+  }
+}
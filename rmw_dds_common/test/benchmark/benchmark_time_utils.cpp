@@ -0,0 +1,82 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+
+#include "rcutils/macros.h"
+
+#include "rmw/qos_profiles.h"
+
+#include "rmw_dds_common/time_utils.hpp"
+
+using performance_test_fixture::PerformanceTest;
+
+BENCHMARK_F(PerformanceTest, clamp_rmw_time_to_dds_time_benchmark)(benchmark::State & st)
+{
+  rmw_time_t time{1, 1500000000ULL};
+
+  reset_heap_counters();
+
+  for (auto _ : st) {
+    RCUTILS_UNUSED(_);
+    benchmark::DoNotOptimize(time);
+    rmw_time_t clamped = rmw_dds_common::clamp_rmw_time_to_dds_time(time);
+    benchmark::DoNotOptimize(clamped);
+  }
+}
+
+BENCHMARK_F(PerformanceTest, rmw_time_to_dds_duration_benchmark)(benchmark::State & st)
+{
+  rmw_time_t time{1, 1500000000ULL};
+
+  reset_heap_counters();
+
+  for (auto _ : st) {
+    RCUTILS_UNUSED(_);
+    benchmark::DoNotOptimize(time);
+    rmw_dds_common::DDSDuration duration = rmw_dds_common::rmw_time_to_dds_duration(time);
+    benchmark::DoNotOptimize(duration);
+  }
+}
+
+BENCHMARK_F(PerformanceTest, dds_duration_to_rmw_time_benchmark)(benchmark::State & st)
+{
+  rmw_dds_common::DDSDuration duration{1, 500000000u};
+
+  reset_heap_counters();
+
+  for (auto _ : st) {
+    RCUTILS_UNUSED(_);
+    benchmark::DoNotOptimize(duration);
+    rmw_time_t time = rmw_dds_common::dds_duration_to_rmw_time(duration);
+    benchmark::DoNotOptimize(time);
+  }
+}
+
+BENCHMARK_F(PerformanceTest, qos_profile_to_dds_durations_benchmark)(benchmark::State & st)
+{
+  rmw_qos_profile_t qos = rmw_qos_profile_default;
+  qos.deadline = {1, 500000000ULL};
+  qos.lifespan = RMW_DURATION_INFINITE;
+  qos.liveliness_lease_duration = {0x80000000, 0};
+
+  reset_heap_counters();
+
+  for (auto _ : st) {
+    RCUTILS_UNUSED(_);
+    benchmark::DoNotOptimize(qos);
+    rmw_dds_common::DDSQoSDurations durations = rmw_dds_common::qos_profile_to_dds_durations(qos);
+    benchmark::DoNotOptimize(durations);
+  }
+}
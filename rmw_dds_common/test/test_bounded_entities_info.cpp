@@ -0,0 +1,98 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "rmw_dds_common/bounded_entities_info.hpp"
+#include "rmw_dds_common/msg/bounded_participant_entities_info.hpp"
+#include "rmw_dds_common/msg/participant_entities_info.hpp"
+
+using rmw_dds_common::msg::BoundedNodeEntitiesInfo;
+using rmw_dds_common::msg::BoundedParticipantEntitiesInfo;
+using rmw_dds_common::msg::ParticipantEntitiesInfo;
+
+static constexpr size_t max_nodes =
+  std::tuple_size<decltype(BoundedParticipantEntitiesInfo::node_entities_info_seq)>::value;
+static constexpr size_t max_endpoints =
+  std::tuple_size<decltype(BoundedNodeEntitiesInfo::reader_gid_seq)>::value;
+
+static
+rmw_dds_common::msg::Gid
+make_gid(uint8_t value)
+{
+  rmw_dds_common::msg::Gid gid;
+  gid.data = {};
+  gid.data[0] = value;
+  return gid;
+}
+
+TEST(test_bounded_entities_info, round_trip)
+{
+  ParticipantEntitiesInfo msg;
+  msg.gid = make_gid(1);
+  msg.node_entities_info_seq.resize(2);
+  msg.node_entities_info_seq[0].node_namespace = "/ns";
+  msg.node_entities_info_seq[0].node_name = "node1";
+  msg.node_entities_info_seq[0].reader_gid_seq = {make_gid(2), make_gid(3)};
+  msg.node_entities_info_seq[1].node_namespace = "/";
+  msg.node_entities_info_seq[1].node_name = std::string(256, 'a');
+  msg.node_entities_info_seq[1].writer_gid_seq = {make_gid(4)};
+  EXPECT_TRUE(rmw_dds_common::fits_in_bounded_msg(msg));
+
+  auto bounded_msg = std::make_unique<BoundedParticipantEntitiesInfo>();
+  ASSERT_TRUE(rmw_dds_common::convert_to_bounded_msg(&msg, bounded_msg.get()));
+  EXPECT_EQ(2u, bounded_msg->node_entities_info_count);
+  EXPECT_EQ(2u, bounded_msg->node_entities_info_seq[0].reader_gid_count);
+  EXPECT_EQ(0u, bounded_msg->node_entities_info_seq[0].writer_gid_count);
+
+  ParticipantEntitiesInfo converted_msg;
+  rmw_dds_common::convert_from_bounded_msg(bounded_msg.get(), &converted_msg);
+  EXPECT_EQ(msg, converted_msg);
+}
+
+TEST(test_bounded_entities_info, exceeds_capacity)
+{
+  ParticipantEntitiesInfo msg;
+  msg.gid = make_gid(1);
+  msg.node_entities_info_seq.resize(1);
+  msg.node_entities_info_seq[0].node_name = "node";
+  msg.node_entities_info_seq[0].writer_gid_seq.resize(max_endpoints + 1);
+  EXPECT_FALSE(rmw_dds_common::fits_in_bounded_msg(msg));
+
+  auto bounded_msg = std::make_unique<BoundedParticipantEntitiesInfo>();
+  bounded_msg->node_entities_info_count = 42u;
+  EXPECT_FALSE(rmw_dds_common::convert_to_bounded_msg(&msg, bounded_msg.get()));
+  EXPECT_EQ(42u, bounded_msg->node_entities_info_count);
+
+  msg.node_entities_info_seq[0].writer_gid_seq.clear();
+  msg.node_entities_info_seq.resize(max_nodes + 1);
+  EXPECT_FALSE(rmw_dds_common::fits_in_bounded_msg(msg));
+}
+
+TEST(test_bounded_entities_info, invalid_counts_are_clamped)
+{
+  auto bounded_msg = std::make_unique<BoundedParticipantEntitiesInfo>();
+  bounded_msg->node_entities_info_count = static_cast<uint32_t>(max_nodes + 1);
+  bounded_msg->node_entities_info_seq[0].reader_gid_count =
+    static_cast<uint32_t>(max_endpoints + 1);
+
+  ParticipantEntitiesInfo msg;
+  rmw_dds_common::convert_from_bounded_msg(bounded_msg.get(), &msg);
+  ASSERT_EQ(max_nodes, msg.node_entities_info_seq.size());
+  EXPECT_EQ(max_endpoints, msg.node_entities_info_seq[0].reader_gid_seq.size());
+}
@@ -0,0 +1,411 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "rmw/qos_profiles.h"
+#include "rmw/types.h"
+
+#include "rmw_dds_common/context.hpp"
+#include "rmw_dds_common/gid_utils.hpp"
+#include "rmw_dds_common/msg/bounded_participant_entities_info.hpp"
+#include "rmw_dds_common/msg/graph_snapshot.hpp"
+#include "rmw_dds_common/msg/graph_snapshot_request.hpp"
+#include "rmw_dds_common/msg/participant_entities_info.hpp"
+#include "rmw_dds_common/msg/participant_node_entities_info.hpp"
+
+using rmw_dds_common::Context;
+using rmw_dds_common::operator==;
+
+static
+rmw_gid_t
+gid_from_string(const std::string & str)
+{
+  rmw_gid_t gid = {};
+  EXPECT_LT(str.size(), RMW_GID_STORAGE_SIZE);
+  memcpy(gid.data, str.c_str(), str.size() + 1);
+  return gid;
+}
+
+class TestContext : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    context.gid = gid_from_string("participant");
+    context.pub = &pub;
+    context.publish_callback = [this](const rmw_publisher_t * publisher, const void * msg) {
+        if (&node_pub == publisher) {
+          last_node_msgs.push_back(
+            *static_cast<const rmw_dds_common::msg::ParticipantNodeEntitiesInfo *>(msg));
+          return publish_ret;
+        }
+        last_msg = *static_cast<const rmw_dds_common::msg::ParticipantEntitiesInfo *>(msg);
+        published_count++;
+        return publish_ret;
+      };
+    context.graph_cache.add_participant(context.gid, "");
+    ASSERT_EQ(RMW_RET_OK, context.add_node_graph("node", "/ns"));
+  }
+
+  rmw_publisher_t pub{};
+  rmw_publisher_t node_pub{};
+  Context context;
+  rmw_dds_common::msg::ParticipantEntitiesInfo last_msg;
+  std::vector<rmw_dds_common::msg::ParticipantNodeEntitiesInfo> last_node_msgs;
+  size_t published_count = 0u;
+  rmw_ret_t publish_ret = RMW_RET_OK;
+};
+
+TEST_F(TestContext, local_entities)
+{
+  rmw_gid_t pub_gid = gid_from_string("pub");
+  rmw_gid_t sub_gid = gid_from_string("sub");
+  rmw_gid_t untracked_gid = gid_from_string("untracked");
+
+  EXPECT_EQ(
+    RMW_RET_OK,
+    context.add_publisher_graph(pub_gid, "rt/chatter", "String", "node", "/ns"));
+  EXPECT_EQ(
+    RMW_RET_OK,
+    context.add_subscriber_graph(sub_gid, "rt/chatter", "String", "node", "/ns"));
+  EXPECT_EQ(RMW_RET_OK, context.add_publisher_graph(untracked_gid, "node", "/ns"));
+  EXPECT_EQ(4u, published_count);
+  ASSERT_EQ(1u, last_msg.node_entities_info_seq.size());
+  EXPECT_EQ(2u, last_msg.node_entities_info_seq[0].writer_gid_seq.size());
+
+  size_t count = 0u;
+  EXPECT_EQ(RMW_RET_OK, context.local_entities.get_writer_count("rt/chatter", &count));
+  EXPECT_EQ(1u, count);
+  EXPECT_EQ(RMW_RET_OK, context.local_entities.get_reader_count("rt/chatter", &count));
+  EXPECT_EQ(1u, count);
+  EXPECT_EQ(RMW_RET_OK, context.local_entities.get_reader_count("rt/other", &count));
+  EXPECT_EQ(0u, count);
+  EXPECT_EQ(
+    RMW_RET_INVALID_ARGUMENT,
+    context.local_entities.get_reader_count("rt/chatter", nullptr));
+
+  auto writers = context.local_entities.get_writers_by_node("node", "/ns");
+  ASSERT_EQ(1u, writers.size());
+  EXPECT_TRUE(writers[0].gid == pub_gid);
+  EXPECT_EQ("rt/chatter", writers[0].topic_name);
+  EXPECT_EQ("String", writers[0].type_name);
+  auto readers = context.local_entities.get_readers_by_node("node", "/ns");
+  ASSERT_EQ(1u, readers.size());
+  EXPECT_TRUE(readers[0].gid == sub_gid);
+  EXPECT_TRUE(context.local_entities.get_readers_by_node("other_node", "/ns").empty());
+
+  EXPECT_EQ(RMW_RET_OK, context.remove_publisher_graph(pub_gid, "node", "/ns"));
+  EXPECT_EQ(RMW_RET_OK, context.remove_subscriber_graph(sub_gid, "node", "/ns"));
+  EXPECT_EQ(RMW_RET_OK, context.local_entities.get_writer_count("rt/chatter", &count));
+  EXPECT_EQ(0u, count);
+  EXPECT_TRUE(context.local_entities.get_readers_by_node("node", "/ns").empty());
+}
+
+TEST_F(TestContext, local_entities_publish_failure)
+{
+  publish_ret = RMW_RET_ERROR;
+  rmw_gid_t pub_gid = gid_from_string("pub");
+  EXPECT_EQ(
+    RMW_RET_ERROR,
+    context.add_publisher_graph(pub_gid, "rt/chatter", "String", "node", "/ns"));
+
+  size_t count = 0u;
+  EXPECT_EQ(RMW_RET_OK, context.local_entities.get_writer_count("rt/chatter", &count));
+  EXPECT_EQ(0u, count);
+  EXPECT_TRUE(context.local_entities.get_writers_by_node("node", "/ns").empty());
+}
+
+TEST_F(TestContext, node_pub)
+{
+  context.node_pub = &node_pub;
+  context.pub = nullptr;
+
+  rmw_gid_t pub_gid = gid_from_string("pub");
+  EXPECT_EQ(RMW_RET_OK, context.add_node_graph("other_node", "/ns"));
+  EXPECT_EQ(RMW_RET_OK, context.add_publisher_graph(pub_gid, "node", "/ns"));
+  EXPECT_EQ(RMW_RET_OK, context.remove_node_graph("other_node", "/ns"));
+  EXPECT_EQ(1u, published_count);
+
+  ASSERT_EQ(3u, last_node_msgs.size());
+  for (const auto & node_msg : last_node_msgs) {
+    EXPECT_EQ(node_msg.gid.data[0], 'p');
+  }
+  EXPECT_EQ("other_node", last_node_msgs[0].node_name);
+  EXPECT_FALSE(last_node_msgs[0].node_removed);
+  EXPECT_EQ("node", last_node_msgs[1].node_name);
+  EXPECT_EQ("/ns", last_node_msgs[1].node_namespace);
+  EXPECT_EQ(1u, last_node_msgs[1].writer_gid_seq.size());
+  EXPECT_FALSE(last_node_msgs[1].node_removed);
+  EXPECT_EQ("other_node", last_node_msgs[2].node_name);
+  EXPECT_TRUE(last_node_msgs[2].node_removed);
+
+  // Both messages are published when both publishers are set.
+  context.pub = &pub;
+  EXPECT_EQ(RMW_RET_OK, context.remove_publisher_graph(pub_gid, "node", "/ns"));
+  EXPECT_EQ(2u, published_count);
+  EXPECT_EQ(4u, last_node_msgs.size());
+  EXPECT_TRUE(last_node_msgs.back().writer_gid_seq.empty());
+}
+
+TEST_F(TestContext, bounded_pub)
+{
+  rmw_publisher_t bounded_pub{};
+  auto loaned_msg = std::make_unique<rmw_dds_common::msg::BoundedParticipantEntitiesInfo>();
+  size_t loaned_published_count = 0u;
+  context.bounded_pub = &bounded_pub;
+  context.borrow_loaned_message_callback =
+    [&](const rmw_publisher_t * publisher, void ** msg) {
+      EXPECT_EQ(&bounded_pub, publisher);
+      *msg = loaned_msg.get();
+      return RMW_RET_OK;
+    };
+  context.publish_loaned_message_callback =
+    [&](const rmw_publisher_t * publisher, void * msg) {
+      EXPECT_EQ(&bounded_pub, publisher);
+      EXPECT_EQ(loaned_msg.get(), msg);
+      loaned_published_count++;
+      return RMW_RET_OK;
+    };
+  size_t loaned_returned_count = 0u;
+  context.return_loaned_message_callback =
+    [&](const rmw_publisher_t * publisher, void * msg) {
+      EXPECT_EQ(&bounded_pub, publisher);
+      EXPECT_EQ(loaned_msg.get(), msg);
+      loaned_returned_count++;
+      return RMW_RET_OK;
+    };
+
+  const size_t max_endpoints = std::tuple_size<
+    decltype(rmw_dds_common::msg::BoundedNodeEntitiesInfo::writer_gid_seq)>::value;
+  std::vector<rmw_gid_t> gids(max_endpoints + 1);
+  for (size_t i = 0; i < gids.size(); i++) {
+    gids[i] = gid_from_string("pub" + std::to_string(i));
+  }
+
+  for (size_t i = 0; i < max_endpoints; i++) {
+    EXPECT_EQ(RMW_RET_OK, context.add_publisher_graph(gids[i], "node", "/ns"));
+  }
+  EXPECT_EQ(max_endpoints, loaned_published_count);
+  EXPECT_EQ(1u, published_count);
+  EXPECT_EQ(1u, loaned_msg->node_entities_info_count);
+  EXPECT_EQ(max_endpoints, loaned_msg->node_entities_info_seq[0].writer_gid_count);
+
+  // Falls back to the unbounded message when the node doesn't fit.
+  EXPECT_EQ(RMW_RET_OK, context.add_publisher_graph(gids.back(), "node", "/ns"));
+  EXPECT_EQ(max_endpoints, loaned_published_count);
+  EXPECT_EQ(2u, published_count);
+  ASSERT_EQ(1u, last_msg.node_entities_info_seq.size());
+  EXPECT_EQ(max_endpoints + 1, last_msg.node_entities_info_seq[0].writer_gid_seq.size());
+
+  // Falls back to the unbounded message when a message can't be borrowed.
+  context.borrow_loaned_message_callback =
+    [](const rmw_publisher_t *, void **) {
+      return RMW_RET_UNSUPPORTED;
+    };
+  EXPECT_EQ(RMW_RET_OK, context.remove_publisher_graph(gids.back(), "node", "/ns"));
+  EXPECT_EQ(max_endpoints, loaned_published_count);
+  EXPECT_EQ(3u, published_count);
+  EXPECT_EQ(0u, loaned_returned_count);
+
+  // The loan is returned before falling back when publishing it fails.
+  context.borrow_loaned_message_callback =
+    [&](const rmw_publisher_t *, void ** msg) {
+      *msg = loaned_msg.get();
+      return RMW_RET_OK;
+    };
+  context.publish_loaned_message_callback =
+    [](const rmw_publisher_t *, void *) {
+      return RMW_RET_ERROR;
+    };
+  EXPECT_EQ(RMW_RET_OK, context.remove_publisher_graph(gids[0], "node", "/ns"));
+  EXPECT_EQ(1u, loaned_returned_count);
+  EXPECT_EQ(4u, published_count);
+
+  // Nothing is published if the loan can't be returned.
+  context.return_loaned_message_callback =
+    [](const rmw_publisher_t *, void *) {
+      return RMW_RET_ERROR;
+    };
+  EXPECT_EQ(RMW_RET_ERROR, context.remove_publisher_graph(gids[1], "node", "/ns"));
+  EXPECT_EQ(4u, published_count);
+}
+
+TEST_F(TestContext, reannouncement)
+{
+  using std::chrono::milliseconds;
+  const auto start = std::chrono::steady_clock::now();
+
+  // Disabled by default.
+  context.notify_participant_joined(start);
+  EXPECT_EQ(std::chrono::nanoseconds::max(), context.time_until_reannouncement(start));
+
+  Context::ReannounceConfig config;
+  config.initial_period = milliseconds(100);
+  config.max_period = milliseconds(300);
+  config.jitter = 0.5;
+  EXPECT_EQ(RMW_RET_OK, context.set_reannounce_config(config));
+  EXPECT_EQ(std::chrono::nanoseconds::max(), context.time_until_reannouncement(start));
+
+  context.notify_participant_joined(start);
+  auto timeout = context.time_until_reannouncement(start);
+  EXPECT_GE(timeout, milliseconds(50));
+  EXPECT_LE(timeout, milliseconds(150));
+
+  // Nothing is published before the deadline.
+  EXPECT_EQ(RMW_RET_OK, context.process_reannouncement(start));
+  EXPECT_EQ(1u, published_count);
+
+  auto now = start + timeout;
+  EXPECT_EQ(std::chrono::nanoseconds(0), context.time_until_reannouncement(now));
+  EXPECT_EQ(RMW_RET_OK, context.process_reannouncement(now));
+  EXPECT_EQ(2u, published_count);
+  ASSERT_EQ(1u, last_msg.node_entities_info_seq.size());
+  EXPECT_EQ("node", last_msg.node_entities_info_seq[0].node_name);
+
+  // The period backs off while participants keep joining.
+  context.notify_participant_joined(now);
+  timeout = context.time_until_reannouncement(now);
+  EXPECT_GE(timeout, milliseconds(100));
+  EXPECT_LE(timeout, milliseconds(300));
+  now += timeout;
+  EXPECT_EQ(RMW_RET_OK, context.process_reannouncement(now));
+  EXPECT_EQ(3u, published_count);
+
+  context.notify_participant_joined(now);
+  timeout = context.time_until_reannouncement(now);
+  EXPECT_GE(timeout, milliseconds(150));
+  EXPECT_LE(timeout, milliseconds(450));
+  now += timeout;
+  EXPECT_EQ(RMW_RET_OK, context.process_reannouncement(now));
+  EXPECT_EQ(4u, published_count);
+
+  // Nothing is republished without new participants, and re-announcements stop.
+  now += context.time_until_reannouncement(now);
+  EXPECT_EQ(RMW_RET_OK, context.process_reannouncement(now));
+  EXPECT_EQ(4u, published_count);
+  EXPECT_EQ(std::chrono::nanoseconds::max(), context.time_until_reannouncement(now));
+
+  // The period is reset after a quiet period.
+  context.notify_participant_joined(now);
+  timeout = context.time_until_reannouncement(now);
+  EXPECT_GE(timeout, milliseconds(50));
+  EXPECT_LE(timeout, milliseconds(150));
+
+  // Invalid settings are rejected and the current ones kept.
+  Context::ReannounceConfig invalid_config = config;
+  invalid_config.max_period = milliseconds(50);
+  EXPECT_EQ(RMW_RET_INVALID_ARGUMENT, context.set_reannounce_config(invalid_config));
+  invalid_config.initial_period = milliseconds(-100);
+  EXPECT_EQ(RMW_RET_INVALID_ARGUMENT, context.set_reannounce_config(invalid_config));
+  EXPECT_EQ(timeout, context.time_until_reannouncement(now));
+
+  // The period saturates at `max_period` instead of overflowing.
+  config.initial_period = std::chrono::nanoseconds::max() / 2 + milliseconds(1);
+  config.max_period = config.initial_period + milliseconds(1);
+  config.jitter = 0.0;
+  EXPECT_EQ(RMW_RET_OK, context.set_reannounce_config(config));
+  now = std::chrono::steady_clock::time_point{} - config.max_period;
+  context.notify_participant_joined(now);
+  now += context.time_until_reannouncement(now);
+  context.notify_participant_joined(now);
+  EXPECT_EQ(RMW_RET_OK, context.process_reannouncement(now));
+  EXPECT_EQ(config.max_period, context.time_until_reannouncement(now));
+}
+
+TEST_F(TestContext, graph_snapshot)
+{
+  rmw_publisher_t snapshot_request_pub{};
+  rmw_publisher_t snapshot_pub{};
+  rmw_publisher_t peer_snapshot_request_pub{};
+  rmw_publisher_t peer_snapshot_pub{};
+  const auto expiry = std::chrono::steady_clock::now() + std::chrono::hours(1);
+
+  // Already synchronized peer, that knows about a remote participant.
+  Context peer;
+  peer.gid = gid_from_string("peer");
+  peer.snapshot_request_pub = &peer_snapshot_request_pub;
+  peer.snapshot_pub = &peer_snapshot_pub;
+  peer.graph_cache.add_participant(peer.gid, "");
+  rmw_gid_t remote_gid = gid_from_string("remote");
+  rmw_dds_common::msg::ParticipantEntitiesInfo remote_msg;
+  peer.graph_cache.add_participant(remote_gid, "");
+  remote_msg = peer.graph_cache.add_node(remote_gid, "remote_node", "/ns");
+  peer.graph_cache.update_participant_entities(remote_msg);
+  EXPECT_TRUE(
+    peer.graph_cache.add_writer(
+      gid_from_string("remote_pub"), "rt/chatter", "String",
+      rosidl_get_zero_initialized_type_hash(), remote_gid, rmw_qos_profile_default));
+
+  // In-process stand-in for the snapshot topics.
+  size_t snapshots_published = 0u;
+  Context * contexts[] = {&context, &peer};
+  auto transport = [&](const rmw_publisher_t * publisher, const void * msg) {
+      if (&snapshot_request_pub == publisher || &peer_snapshot_request_pub == publisher) {
+        const auto & request = *static_cast<const rmw_dds_common::msg::GraphSnapshotRequest *>(msg);
+        for (Context * c : contexts) {
+          EXPECT_EQ(RMW_RET_OK, c->handle_graph_snapshot_request(request));
+        }
+        return RMW_RET_OK;
+      }
+      if (&snapshot_pub == publisher || &peer_snapshot_pub == publisher) {
+        snapshots_published++;
+        const auto & snapshot = *static_cast<const rmw_dds_common::msg::GraphSnapshot *>(msg);
+        for (Context * c : contexts) {
+          c->handle_graph_snapshot(snapshot, expiry);
+        }
+        return RMW_RET_OK;
+      }
+      return publish_ret;
+    };
+  context.snapshot_request_pub = &snapshot_request_pub;
+  context.snapshot_pub = &snapshot_pub;
+  context.publish_callback = transport;
+  peer.publish_callback = transport;
+
+  EXPECT_EQ(RMW_RET_OK, context.request_graph_snapshot(peer.gid));
+  EXPECT_EQ(1u, snapshots_published);
+  EXPECT_TRUE(context.graph_cache.has_provisional_entries());
+  EXPECT_FALSE(peer.graph_cache.has_provisional_entries());
+  size_t count = 0u;
+  EXPECT_EQ(RMW_RET_OK, context.graph_cache.get_writer_count("rt/chatter", &count));
+  EXPECT_EQ(1u, count);
+  EXPECT_EQ(2u, context.graph_cache.get_number_of_nodes());
+
+  // Snapshots that don't reply to a pending request are ignored.
+  rmw_dds_common::msg::GraphSnapshotRequest request;
+  rmw_dds_common::convert_gid_to_msg(&context.gid, &request.requester_gid);
+  rmw_dds_common::convert_gid_to_msg(&peer.gid, &request.responder_gid);
+  EXPECT_EQ(RMW_RET_OK, peer.handle_graph_snapshot_request(request));
+  EXPECT_EQ(2u, snapshots_published);
+  EXPECT_FALSE(context.handle_graph_snapshot(peer.graph_cache.get_snapshot(), expiry));
+
+  // A failed request is not pending.
+  context.snapshot_request_pub = nullptr;
+  EXPECT_EQ(RMW_RET_ERROR, context.request_graph_snapshot(peer.gid));
+
+  // Live discovery data confirms the snapshot.
+  context.graph_cache.update_participant_entities(remote_msg);
+  EXPECT_TRUE(context.graph_cache.expire_provisional_entries(expiry + std::chrono::hours(1)));
+  EXPECT_EQ(2u, context.graph_cache.get_number_of_nodes());
+  EXPECT_EQ(RMW_RET_OK, context.graph_cache.get_writer_count("rt/chatter", &count));
+  EXPECT_EQ(0u, count);
+}
@@ -0,0 +1,134 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "rmw/types.h"
+#include "rosidl_runtime_c/type_hash.h"
+
+#include "rmw_dds_common/entity_gid_map.hpp"
+#include "rmw_dds_common/gid_utils.hpp"
+
+using rmw_dds_common::EntityGidMap;
+using rmw_dds_common::EntityInfo;
+using rmw_dds_common::operator==;
+
+static
+rmw_gid_t
+make_gid(uint8_t participant, uint32_t entity_id)
+{
+  EntityGidMap::Prefix prefix{};
+  prefix[0] = participant;
+  return EntityGidMap::join_gid(prefix, entity_id);
+}
+
+static
+EntityInfo
+make_info(const std::string & topic_name)
+{
+  return EntityInfo(
+    topic_name, "type", rosidl_get_zero_initialized_type_hash(), rmw_qos_profile_t{});
+}
+
+// Entity id of a DDS participant.
+static constexpr uint32_t participant_entity_id = 0x000001c1u;
+
+TEST(test_entity_gid_map, split_and_join)
+{
+  rmw_gid_t gid{};
+  for (uint8_t i = 0u; i < RMW_GID_STORAGE_SIZE; i++) {
+    const_cast<uint8_t *>(gid.data)[i] = i;
+  }
+  auto split = EntityGidMap::split_gid(gid);
+  EXPECT_EQ(0u, split.first[0]);
+  EXPECT_EQ(11u, split.first[11]);
+  EXPECT_EQ(0x0C0D0E0Fu, split.second);
+  EXPECT_TRUE(gid == EntityGidMap::join_gid(split.first, split.second));
+}
+
+TEST(test_entity_gid_map, grouped_by_participant)
+{
+  const rmw_gid_t participant1 = make_gid(1u, participant_entity_id);
+  const rmw_gid_t participant2 = make_gid(2u, participant_entity_id);
+  EntityGidMap map;
+  EXPECT_TRUE(map.emplace(make_gid(2u, 0x107u), participant2, make_info("topic3")));
+  EXPECT_TRUE(map.emplace(make_gid(1u, 0x204u), participant1, make_info("topic2")));
+  EXPECT_TRUE(map.emplace(make_gid(1u, 0x103u), participant1, make_info("topic1")));
+  EXPECT_FALSE(map.emplace(make_gid(1u, 0x103u), participant2, make_info("topic4")));
+  EXPECT_EQ(3u, map.size());
+  EXPECT_EQ(2u, map.groups().size());
+
+  rmw_gid_t participant_gid{};
+  const EntityInfo * info = map.find(make_gid(1u, 0x103u), &participant_gid);
+  ASSERT_NE(nullptr, info);
+  EXPECT_EQ("topic1", info->topic_name);
+  EXPECT_TRUE(participant_gid == participant1);
+  EXPECT_TRUE(info->participant_gid == participant1);
+  EXPECT_EQ(nullptr, map.find(make_gid(2u, 0x103u)));
+  EXPECT_EQ(0u, map.count(make_gid(3u, 0x103u)));
+
+  // Iterated in gid order.
+  std::vector<std::string> topics;
+  map.for_each(
+    [&topics](const rmw_gid_t &, const rmw_gid_t &, const EntityInfo & info) {
+      topics.push_back(info.topic_name);
+    });
+  EXPECT_EQ((std::vector<std::string>{"topic1", "topic2", "topic3"}), topics);
+
+  EXPECT_EQ(2u, map.erase_participant(participant1));
+  EXPECT_EQ(1u, map.size());
+  EXPECT_EQ(1u, map.groups().size());
+  EXPECT_TRUE(map.erase(make_gid(2u, 0x107u)));
+  EXPECT_FALSE(map.erase(make_gid(2u, 0x107u)));
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.groups().empty());
+}
+
+TEST(test_entity_gid_map, participant_not_matching_prefix)
+{
+  const rmw_gid_t participant1 = make_gid(1u, participant_entity_id);
+  const rmw_gid_t participant2 = make_gid(2u, participant_entity_id);
+  EntityGidMap map;
+  EXPECT_TRUE(map.emplace(make_gid(3u, 1u), participant1, make_info("topic1")));
+  EXPECT_TRUE(map.emplace(make_gid(3u, 2u), participant2, make_info("topic2")));
+  EXPECT_EQ(2u, map.groups().size());
+  EXPECT_NE(nullptr, map.find(make_gid(3u, 1u)));
+  EXPECT_NE(nullptr, map.find(make_gid(3u, 2u)));
+
+  // Replacing with another participant moves the endpoint to the other group.
+  EXPECT_FALSE(map.insert_or_assign(make_gid(3u, 1u), participant2, make_info("topic3")));
+  EXPECT_EQ(1u, map.groups().size());
+  rmw_gid_t participant_gid{};
+  const EntityInfo * info = map.find(make_gid(3u, 1u), &participant_gid);
+  ASSERT_NE(nullptr, info);
+  EXPECT_EQ("topic3", info->topic_name);
+  EXPECT_TRUE(participant_gid == participant2);
+  EXPECT_TRUE(info->participant_gid == participant2);
+  EXPECT_TRUE(map.insert_or_assign(make_gid(3u, 3u), participant1, make_info("topic4")));
+  EXPECT_EQ(3u, map.size());
+
+  EXPECT_EQ(0u, map.erase_participant(make_gid(3u, participant_entity_id)));
+  EXPECT_EQ(2u, map.erase_participant(participant2));
+  EXPECT_EQ(1u, map.size());
+
+  // Matching and mismatched groups of a participant are all removed.
+  EXPECT_TRUE(map.emplace(make_gid(1u, 4u), participant1, make_info("topic5")));
+  EXPECT_EQ(2u, map.groups().size());
+  EXPECT_EQ(2u, map.erase_participant(participant1));
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.groups().empty());
+}
@@ -16,6 +16,12 @@
 #include <gtest/gtest.h>
 #include <string.h>
 
+#if defined(__linux__)
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -31,6 +37,7 @@
 
 #include "rmw_dds_common/gid_utils.hpp"
 #include "rmw_dds_common/graph_cache.hpp"
+#include "rmw_dds_common/qos.hpp"
 
 using rmw_dds_common::GraphCache;
 using rmw_dds_common::operator==;
@@ -1250,6 +1257,876 @@ TEST(test_graph_cache, normal_usage)
   EXPECT_FALSE(change_callback_called);
 }
 
+TEST(test_graph_cache, ingest_filter_topic_name)
+{
+  GraphCache graph_cache;
+  GraphCache::IngestFilter filter;
+  filter.topic_name_prefixes = {"rt/allowed"};
+  graph_cache.set_ingest_filter(filter);
+
+  add_participants(graph_cache, {"participant1"});
+  EXPECT_TRUE(
+    graph_cache.add_entity(
+      gid_from_string("writer1"), "rt/allowed/topic", "Str",
+      rosidl_get_zero_initialized_type_hash(), gid_from_string("participant1"),
+      rmw_qos_profile_default, false));
+  EXPECT_FALSE(
+    graph_cache.add_entity(
+      gid_from_string("reader1"), "rt/other/topic", "Str",
+      rosidl_get_zero_initialized_type_hash(), gid_from_string("participant1"),
+      rmw_qos_profile_default, true));
+
+  size_t count = 0u;
+  EXPECT_EQ(RMW_RET_OK, graph_cache.get_writer_count("rt/allowed/topic", &count));
+  EXPECT_EQ(1u, count);
+  EXPECT_EQ(RMW_RET_OK, graph_cache.get_reader_count("rt/other/topic", &count));
+  EXPECT_EQ(0u, count);
+
+  GraphCache::IngestFilterStats stats = graph_cache.get_ingest_filter_stats();
+  EXPECT_EQ(1u, stats.topic_name_hits);
+  EXPECT_EQ(0u, stats.node_namespace_hits);
+  EXPECT_EQ(0u, stats.enclave_hits);
+  EXPECT_EQ(0u, stats.bare_dds_participant_hits);
+}
+
+TEST(test_graph_cache, ingest_filter_node_namespace)
+{
+  GraphCache graph_cache;
+  GraphCache::IngestFilter filter;
+  filter.node_namespace_prefixes = {"/robot1"};
+  graph_cache.set_ingest_filter(filter);
+
+  add_participants(graph_cache, {"participant1"});
+  add_entities(
+    graph_cache,
+    {
+      {"reader1", "participant1", "topic1", "Str", true},
+      {"writer1", "participant1", "topic1", "Str", false},
+    });
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg(
+  {
+    "participant1",
+    {
+      {"/robot1", "node1", {"reader1"}, {}},
+      {"/robot2", "node2", {}, {"writer1", "writer2"}},
+    },
+  }));
+
+  EXPECT_EQ(1u, graph_cache.get_number_of_nodes());
+  check_results_by_topic(graph_cache, "topic1", 1, 0);
+
+  // Entities of a filtered out node are rejected when discovered later.
+  EXPECT_FALSE(
+    graph_cache.add_entity(
+      gid_from_string("writer2"), "topic1", "Str",
+      rosidl_get_zero_initialized_type_hash(), gid_from_string("participant1"),
+      rmw_qos_profile_default, false));
+  check_results_by_topic(graph_cache, "topic1", 1, 0);
+
+  GraphCache::IngestFilterStats stats = graph_cache.get_ingest_filter_stats();
+  EXPECT_EQ(0u, stats.topic_name_hits);
+  EXPECT_EQ(2u, stats.node_namespace_hits);
+}
+
+TEST(test_graph_cache, ingest_filter_enclave)
+{
+  GraphCache graph_cache;
+  GraphCache::IngestFilter filter;
+  filter.enclaves = {"/allowed"};
+  graph_cache.set_ingest_filter(filter);
+
+  graph_cache.add_participant(gid_from_string("participant1"), "/allowed");
+  graph_cache.add_participant(gid_from_string("participant2"), "/other");
+  add_entities(
+    graph_cache,
+    {
+      {"reader1", "participant1", "topic1", "Str", true},
+    });
+  EXPECT_FALSE(
+    graph_cache.add_entity(
+      gid_from_string("writer2"), "topic1", "Str",
+      rosidl_get_zero_initialized_type_hash(), gid_from_string("participant2"),
+      rmw_qos_profile_default, false));
+
+  bool change_callback_called = false;
+  graph_cache.set_on_change_callback(
+    [&change_callback_called]() {
+      change_callback_called = true;
+    });
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg({"participant2", {{"ns", "node2", {}, {"writer2"}}}}));
+  EXPECT_FALSE(change_callback_called);
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg({"participant1", {{"ns", "node1", {"reader1"}, {}}}}));
+  EXPECT_TRUE(change_callback_called);
+
+  EXPECT_EQ(1u, graph_cache.get_number_of_nodes());
+  check_results_by_topic(graph_cache, "topic1", 1, 0);
+
+  GraphCache::IngestFilterStats stats = graph_cache.get_ingest_filter_stats();
+  EXPECT_EQ(3u, stats.enclave_hits);
+}
+
+TEST(test_graph_cache, ingest_filter_existing_entries)
+{
+  GraphCache graph_cache;
+  GraphCache::IngestFilter filter;
+  filter.enclaves = {"/allowed"};
+  graph_cache.set_ingest_filter(filter);
+
+  // Entities discovered before their participant are filtered when it is added.
+  add_entities(
+    graph_cache,
+    {
+      {"writer1", "participant2", "rt/a", "Str", false},
+    });
+  check_results_by_topic(graph_cache, "rt/a", 0, 1);
+  graph_cache.add_participant(gid_from_string("participant2"), "/other");
+  check_results_by_topic(graph_cache, "rt/a", 0, 0);
+
+  graph_cache.add_participant(gid_from_string("participant1"), "/allowed");
+  add_entities(
+    graph_cache,
+    {
+      {"reader1", "participant1", "rt/a", "Str", true},
+      {"writer3", "participant1", "rt/b", "Str", false},
+    });
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg(
+  {
+    "participant1",
+    {
+      {"/robot1", "node1", {"reader1"}, {}},
+      {"/robot2", "node2", {}, {"writer3"}},
+    },
+  }));
+  EXPECT_EQ(2u, graph_cache.get_number_of_nodes());
+
+  size_t change_callback_calls = 0u;
+  graph_cache.set_on_change_callback(
+    [&change_callback_calls]() {
+      change_callback_calls++;
+    });
+
+  // Setting a filter applies it to the data already in the cache.
+  filter.topic_name_prefixes = {"rt/a"};
+  filter.node_namespace_prefixes = {"/robot1"};
+  graph_cache.set_ingest_filter(filter);
+  EXPECT_EQ(1u, change_callback_calls);
+  EXPECT_EQ(1u, graph_cache.get_number_of_nodes());
+  check_results_by_topic(graph_cache, "rt/a", 1, 0);
+  check_results_by_topic(graph_cache, "rt/b", 0, 0);
+  GraphCache::IngestFilterStats stats = graph_cache.get_ingest_filter_stats();
+  EXPECT_EQ(1u, stats.node_namespace_hits);
+  EXPECT_EQ(0u, stats.topic_name_hits);
+
+  graph_cache.set_ingest_filter(filter);
+  EXPECT_EQ(1u, change_callback_calls);
+
+  filter.enclaves = {"/robot"};
+  graph_cache.set_ingest_filter(filter);
+  EXPECT_EQ(2u, change_callback_calls);
+  EXPECT_EQ(0u, graph_cache.get_number_of_nodes());
+  check_results_by_topic(graph_cache, "rt/a", 0, 0);
+  EXPECT_EQ(2u, graph_cache.get_ingest_filter_stats().enclave_hits);
+}
+
+TEST(test_graph_cache, ingest_filter_bare_dds_participants)
+{
+  GraphCache graph_cache;
+  GraphCache::IngestFilter filter;
+  filter.bare_dds_participant_grace_period = std::chrono::nanoseconds(0);
+  graph_cache.set_ingest_filter(filter);
+
+  // Without a grace period left, entities of participants that never sent ROS discovery
+  // information are rejected.
+  add_participants(graph_cache, {"participant1", "participant2"});
+  EXPECT_FALSE(
+    graph_cache.add_entity(
+      gid_from_string("writer1"), "topic1", "Str",
+      rosidl_get_zero_initialized_type_hash(), gid_from_string("participant1"),
+      rmw_qos_profile_default, false));
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg({"participant2", {{"ns", "node2", {"reader2"}, {}}}}));
+  add_entities(
+    graph_cache,
+    {
+      {"reader2", "participant2", "topic1", "Str", true},
+    });
+  check_results_by_topic(graph_cache, "topic1", 1, 0);
+  EXPECT_EQ(1u, graph_cache.get_ingest_filter_stats().bare_dds_participant_hits);
+
+  // Entities stored during the grace period are pruned once it expires.
+  filter.bare_dds_participant_grace_period = std::chrono::hours(1);
+  graph_cache.set_ingest_filter(filter);
+  add_participants(graph_cache, {"participant3"});
+  add_entities(
+    graph_cache,
+    {
+      {"writer3", "participant3", "topic1", "Str", false},
+    });
+  check_results_by_topic(graph_cache, "topic1", 1, 1);
+  EXPECT_FALSE(graph_cache.prune_bare_dds_participants());
+  check_results_by_topic(graph_cache, "topic1", 1, 1);
+
+  filter.bare_dds_participant_grace_period = std::chrono::nanoseconds(0);
+  graph_cache.set_ingest_filter(filter);
+  EXPECT_TRUE(graph_cache.prune_bare_dds_participants());
+  check_results_by_topic(graph_cache, "topic1", 1, 0);
+  EXPECT_FALSE(graph_cache.prune_bare_dds_participants());
+  EXPECT_EQ(2u, graph_cache.get_ingest_filter_stats().bare_dds_participant_hits);
+}
+
+TEST(test_graph_cache, update_rate_limit)
+{
+  GraphCache graph_cache;
+  GraphCache::UpdateRateLimit rate_limit;
+  rate_limit.updates_per_second = 1.0;
+  rate_limit.burst = 1u;
+  graph_cache.set_update_rate_limit(rate_limit);
+
+  size_t change_callback_calls = 0u;
+  graph_cache.set_on_change_callback(
+    [&change_callback_calls]() {
+      change_callback_calls++;
+    });
+
+  add_participants(graph_cache, {"participant1", "participant2"});
+  change_callback_calls = 0u;
+
+  // The first update of each participant consumes its token.
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg({"participant1", {{"ns", "node1", {}, {}}}}));
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg({"participant2", {{"ns", "node2", {}, {}}}}));
+  EXPECT_EQ(2u, change_callback_calls);
+  EXPECT_EQ(2u, graph_cache.get_number_of_nodes());
+  EXPECT_FALSE(graph_cache.has_pending_participant_updates());
+
+  // Later updates are throttled, only the latest one is kept.
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg(
+  {
+    "participant1",
+    {
+      {"ns", "node1", {}, {}},
+      {"ns", "node3", {}, {}},
+    },
+  }));
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg(
+  {
+    "participant1",
+    {
+      {"ns", "node1", {}, {}},
+      {"ns", "node3", {}, {}},
+      {"ns", "node4", {}, {}},
+    },
+  }));
+  EXPECT_EQ(2u, change_callback_calls);
+  EXPECT_EQ(2u, graph_cache.get_number_of_nodes());
+  EXPECT_TRUE(graph_cache.has_pending_participant_updates());
+
+  // Bucket is not refilled yet.
+  EXPECT_FALSE(graph_cache.flush_pending_participant_updates(std::chrono::steady_clock::now()));
+  EXPECT_TRUE(graph_cache.has_pending_participant_updates());
+
+  EXPECT_TRUE(
+    graph_cache.flush_pending_participant_updates(
+      std::chrono::steady_clock::now() + std::chrono::seconds(2)));
+  EXPECT_EQ(3u, change_callback_calls);
+  EXPECT_EQ(4u, graph_cache.get_number_of_nodes());
+  EXPECT_FALSE(graph_cache.has_pending_participant_updates());
+
+  GraphCache::UpdateRateLimitStats stats = graph_cache.get_update_rate_limit_stats();
+  EXPECT_EQ(2u, stats.throttled_updates);
+  EXPECT_EQ(1u, stats.coalesced_updates);
+  EXPECT_EQ(1u, stats.flushed_updates);
+
+  // Pending updates of removed participants are dropped.
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg({"participant2", {}}));
+  EXPECT_TRUE(graph_cache.has_pending_participant_updates());
+  remove_participants(graph_cache, {"participant2"});
+  EXPECT_FALSE(graph_cache.has_pending_participant_updates());
+
+  // An empty bucket would throttle every update, the burst is at least 1.
+  rate_limit.burst = 0u;
+  graph_cache.set_update_rate_limit(rate_limit);
+  add_participants(graph_cache, {"participant3"});
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg({"participant3", {{"ns", "node5", {}, {}}}}));
+  EXPECT_FALSE(graph_cache.has_pending_participant_updates());
+  EXPECT_EQ(4u, graph_cache.get_number_of_nodes());
+}
+
+TEST(test_graph_cache, removal_hysteresis)
+{
+  GraphCache graph_cache;
+  graph_cache.set_removal_hysteresis(std::chrono::hours(1));
+
+  size_t change_callback_calls = 0u;
+  graph_cache.set_on_change_callback(
+    [&change_callback_calls]() {
+      change_callback_calls++;
+    });
+
+  add_entities(
+    graph_cache,
+    {
+      {"reader1", "participant1", "topic1", "Str", true},
+      {"writer1", "participant1", "topic1", "Str", false},
+      {"writer2", "participant1", "topic2", "Str", false},
+    });
+  EXPECT_EQ(3u, change_callback_calls);
+
+  // Removals are held, held entities are still reported.
+  remove_entities(
+    graph_cache,
+    {
+      {"reader1", "participant1", "topic1", "Str", true},
+      {"writer1", "participant1", "topic1", "Str", false},
+      {"writer2", "participant1", "topic2", "Str", false},
+    });
+  EXPECT_FALSE(graph_cache.remove_writer(gid_from_string("writer1")));
+  EXPECT_FALSE(graph_cache.remove_writer(gid_from_string("writer3")));
+  EXPECT_EQ(3u, change_callback_calls);
+  EXPECT_TRUE(graph_cache.has_held_removals());
+  check_results_by_topic(graph_cache, "topic1", 1, 1);
+  check_results_by_topic(graph_cache, "topic2", 0, 1);
+
+  // Matching re-adds, with the same or a new gid, are folded.
+  // Only the gid change is notified.
+  add_entities(
+    graph_cache,
+    {
+      {"reader1", "participant1", "topic1", "Str", true},
+    });
+  EXPECT_EQ(3u, change_callback_calls);
+  add_entities(
+    graph_cache,
+    {
+      {"writer1_new", "participant2", "topic1", "Str", false},
+    });
+  EXPECT_EQ(4u, change_callback_calls);
+  check_results_by_topic(graph_cache, "topic1", 1, 1);
+
+  // A re-add with a different QoS is not a match.
+  rmw_qos_profile_t qos = rmw_qos_profile_default;
+  qos.depth++;
+  EXPECT_TRUE(
+    graph_cache.add_entity(
+      gid_from_string("writer2_new"), "topic2", "Str",
+      rosidl_get_zero_initialized_type_hash(), gid_from_string("participant2"), qos, false));
+  EXPECT_EQ(5u, change_callback_calls);
+  check_results_by_topic(graph_cache, "topic2", 0, 2);
+
+  EXPECT_FALSE(graph_cache.flush_held_removals(std::chrono::steady_clock::now()));
+  EXPECT_TRUE(
+    graph_cache.flush_held_removals(std::chrono::steady_clock::now() + std::chrono::hours(2)));
+  EXPECT_EQ(6u, change_callback_calls);
+  EXPECT_FALSE(graph_cache.has_held_removals());
+  check_results_by_topic(graph_cache, "topic1", 1, 1);
+  check_results_by_topic(graph_cache, "topic2", 0, 1);
+
+  // Without hysteresis, removals are applied right away.
+  graph_cache.set_removal_hysteresis(std::chrono::nanoseconds(0));
+  EXPECT_TRUE(graph_cache.remove_writer(gid_from_string("writer1_new")));
+  EXPECT_EQ(7u, change_callback_calls);
+  check_results_by_topic(graph_cache, "topic1", 1, 0);
+}
+
+TEST(test_graph_cache, update_node_entities)
+{
+  GraphCache graph_cache;
+  size_t change_callback_calls = 0u;
+  graph_cache.set_on_change_callback(
+    [&change_callback_calls]() {
+      change_callback_calls++;
+    });
+
+  add_participants(graph_cache, {"participant1"});
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg({"participant1", {{"ns1", "node1", {}, {}}}}));
+  change_callback_calls = 0u;
+
+  auto node_msg = [](const std::string & gid, const NodeEntitiesInfo & info, bool removed) {
+      rmw_dds_common::msg::ParticipantNodeEntitiesInfo msg;
+      msg.gid = gid_msg_from_string(gid);
+      auto node_info = get_participant_entities_info_msg({gid, {info}}).node_entities_info_seq[0];
+      msg.node_namespace = node_info.node_namespace;
+      msg.node_name = node_info.node_name;
+      msg.reader_gid_seq = node_info.reader_gid_seq;
+      msg.writer_gid_seq = node_info.writer_gid_seq;
+      msg.node_removed = removed;
+      return msg;
+    };
+
+  // Other nodes of the participant are kept.
+  graph_cache.update_node_entities(
+    node_msg("participant1", {"ns2", "node2", {"reader1"}, {}}, false));
+  EXPECT_EQ(2u, graph_cache.get_number_of_nodes());
+  graph_cache.update_node_entities(
+    node_msg("participant1", {"ns2", "node2", {"reader1"}, {"writer1"}}, false));
+  EXPECT_EQ(2u, graph_cache.get_number_of_nodes());
+  graph_cache.update_node_entities(
+    node_msg("participant2", {"ns1", "node1", {}, {}}, false));
+  EXPECT_EQ(3u, graph_cache.get_number_of_nodes());
+  EXPECT_EQ(3u, change_callback_calls);
+
+  add_entities(
+    graph_cache,
+    {
+      {"reader1", "participant1", "topic1", "Str", true},
+      {"writer1", "participant1", "topic1", "Str", false},
+    });
+  check_results(
+    graph_cache,
+    {
+      {"ns1", "node1"},
+      {"ns2", "node2"},
+      {"ns1", "node1"},
+    },
+  {
+    {"topic1", {"Str"}},
+  });
+  change_callback_calls = 0u;
+
+  graph_cache.update_node_entities(
+    node_msg("participant1", {"ns2", "node2", {}, {}}, true));
+  EXPECT_EQ(2u, graph_cache.get_number_of_nodes());
+  EXPECT_EQ(1u, change_callback_calls);
+  // Removing a node that is not present is not a change.
+  graph_cache.update_node_entities(
+    node_msg("participant1", {"ns2", "node2", {}, {}}, true));
+  EXPECT_EQ(1u, change_callback_calls);
+}
+
+TEST(test_graph_cache, snapshot)
+{
+  GraphCache source;
+  add_participants(source, {"participant1", "participant2"});
+  source.update_participant_entities(
+    get_participant_entities_info_msg({"participant1", {{"ns1", "node1", {"reader1"}, {}}}}));
+  source.update_participant_entities(
+    get_participant_entities_info_msg({"participant2", {{"ns2", "node2", {}, {"writer1"}}}}));
+  add_entities(
+    source,
+    {
+      {"reader1", "participant1", "topic1", "Str", true},
+      {"writer1", "participant2", "topic1", "Str", false},
+      {"writer2", "participant2", "topic2", "Str", false},
+    });
+  rmw_dds_common::msg::GraphSnapshot snapshot = source.get_snapshot();
+  EXPECT_EQ(2u, snapshot.participants.size());
+  EXPECT_EQ(3u, snapshot.entities.size());
+
+  GraphCache graph_cache;
+  size_t change_callback_calls = 0u;
+  graph_cache.set_on_change_callback(
+    [&change_callback_calls]() {
+      change_callback_calls++;
+    });
+  auto now = std::chrono::steady_clock::now();
+  EXPECT_TRUE(graph_cache.load_snapshot(snapshot, now + std::chrono::hours(1)));
+  EXPECT_EQ(1u, change_callback_calls);
+  EXPECT_TRUE(graph_cache.has_provisional_entries());
+  EXPECT_EQ(2u, graph_cache.get_number_of_nodes());
+  check_results_by_topic(graph_cache, "topic1", 1, 1);
+  check_results_by_topic(graph_cache, "topic2", 0, 1);
+  // Loading the same snapshot again is not a change.
+  EXPECT_FALSE(graph_cache.load_snapshot(snapshot, now + std::chrono::hours(1)));
+  EXPECT_EQ(1u, change_callback_calls);
+
+  // Entries confirmed by discovery data are kept, confirming an identical entity is not a change.
+  add_participants(graph_cache, {"participant1"});
+  EXPECT_EQ(2u, change_callback_calls);
+  EXPECT_FALSE(
+    graph_cache.add_reader(
+      gid_from_string("reader1"), "topic1", "Str", gid_from_string("participant1"),
+      rmw_qos_profile_default));
+  EXPECT_EQ(2u, change_callback_calls);
+
+  EXPECT_FALSE(graph_cache.expire_provisional_entries(now));
+  EXPECT_TRUE(graph_cache.expire_provisional_entries(now + std::chrono::hours(2)));
+  EXPECT_EQ(3u, change_callback_calls);
+  EXPECT_FALSE(graph_cache.has_provisional_entries());
+  EXPECT_EQ(1u, graph_cache.get_number_of_nodes());
+  check_results_by_topic(graph_cache, "topic1", 1, 0);
+  check_results_by_topic(graph_cache, "topic2", 0, 0);
+}
+
+TEST(test_graph_cache, compact)
+{
+  GraphCache graph_cache;
+  size_t change_callback_calls = 0u;
+  add_participants(graph_cache, {"participant1", "participant2"});
+  add_entities(
+    graph_cache,
+    {
+      {"reader1", "participant1", "topic1", "Str", true},
+      {"writer1", "participant1", "topic1", "Str", false},
+      {"writer2", "participant2", "topic2", "Str", false},
+    });
+  // Shrinking updates leave unused capacity behind.
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg(
+      {"participant1",
+        {
+          {"ns1", "node1", {"reader1"}, {"writer1"}},
+          {"ns1", "node2", {}, {}},
+          {"ns1", "node3", {}, {}},
+          {"ns1", "node4", {}, {}},
+        }}));
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg({"participant1", {{"ns1", "node1", {"reader1"}, {}}}}));
+  graph_cache.set_on_change_callback(
+    [&change_callback_calls]() {
+      change_callback_calls++;
+    });
+
+  GraphCache::MemoryStats stats = graph_cache.get_memory_stats();
+  EXPECT_EQ(2u, stats.participants);
+  EXPECT_EQ(1u, stats.nodes);
+  EXPECT_EQ(3u, stats.entities);
+  EXPECT_EQ(0u, stats.compaction_passes);
+  const size_t estimated_bytes = stats.estimated_bytes;
+
+  // A zero budget does nothing.
+  EXPECT_FALSE(graph_cache.compact(0u));
+  // Five entries, compacted two at a time.
+  EXPECT_FALSE(graph_cache.compact(2u));
+  EXPECT_FALSE(graph_cache.compact(2u));
+  // Entries removed between steps are skipped.
+  EXPECT_TRUE(graph_cache.remove_writer(gid_from_string("writer2")));
+  EXPECT_TRUE(graph_cache.compact(2u));
+  EXPECT_EQ(1u, change_callback_calls);
+
+  stats = graph_cache.get_memory_stats();
+  EXPECT_EQ(1u, stats.compaction_passes);
+  EXPECT_EQ(4u, stats.compacted_entries);
+  // Too little memory was released to return it to the system.
+  EXPECT_EQ(0u, stats.trims);
+  EXPECT_GE(stats.reclaimed_bytes, 3u * sizeof(rmw_dds_common::msg::NodeEntitiesInfo));
+  EXPECT_LT(stats.estimated_bytes, estimated_bytes);
+  EXPECT_EQ(1u, graph_cache.get_number_of_nodes());
+  check_results_by_topic(graph_cache, "topic1", 1, 1);
+  check_results_by_topic(graph_cache, "topic2", 0, 0);
+
+  // The next pass starts from the beginning.
+  EXPECT_TRUE(graph_cache.compact(10u));
+  stats = graph_cache.get_memory_stats();
+  EXPECT_EQ(2u, stats.compaction_passes);
+  EXPECT_EQ(8u, stats.compacted_entries);
+
+  // An empty cache completes a pass with every non zero budget.
+  GraphCache empty_graph_cache;
+  EXPECT_FALSE(empty_graph_cache.compact(0u));
+  EXPECT_EQ(0u, empty_graph_cache.get_memory_stats().compaction_passes);
+  EXPECT_TRUE(empty_graph_cache.compact(1u));
+  EXPECT_EQ(1u, empty_graph_cache.get_memory_stats().compaction_passes);
+
+#if defined(__GLIBC__)
+  // Memory released by the previous passes is returned with a lower threshold.
+  graph_cache.set_compaction_trim_threshold(1u);
+  EXPECT_TRUE(graph_cache.compact(10u));
+  EXPECT_EQ(1u, graph_cache.get_memory_stats().trims);
+  // Nothing was released since then.
+  EXPECT_TRUE(graph_cache.compact(10u));
+  EXPECT_EQ(1u, graph_cache.get_memory_stats().trims);
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg(
+      {"participant1", {{"ns1", "node1", {"reader1"}, {}}, {"ns1", "node2", {}, {}}}}));
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg({"participant1", {{"ns1", "node1", {"reader1"}, {}}}}));
+  EXPECT_TRUE(graph_cache.compact(10u));
+  EXPECT_EQ(2u, graph_cache.get_memory_stats().trims);
+#endif
+}
+
+TEST(test_graph_cache, change_event_fd)
+{
+  GraphCache graph_cache;
+  EXPECT_EQ(0u, graph_cache.get_graph_generation());
+  add_participants(graph_cache, {"participant1"});
+  EXPECT_EQ(1u, graph_cache.get_graph_generation());
+
+  int fd = graph_cache.get_change_event_fd();
+#if defined(__linux__)
+  ASSERT_NE(-1, fd);
+  EXPECT_EQ(fd, graph_cache.get_change_event_fd());
+  struct pollfd pfd = {fd, POLLIN, 0};
+  // Changes before the fd was created are not signaled.
+  EXPECT_EQ(0, poll(&pfd, 1u, 0));
+
+  add_entities(
+    graph_cache,
+    {
+      {"reader1", "participant1", "topic1", "Str", true},
+      {"writer1", "participant1", "topic1", "Str", false},
+    });
+  // Not a change.
+  EXPECT_FALSE(graph_cache.remove_reader(gid_from_string("reader2")));
+  EXPECT_EQ(3u, graph_cache.get_graph_generation());
+  EXPECT_EQ(1, poll(&pfd, 1u, 0));
+  uint64_t changes = 0u;
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(changes)), read(fd, &changes, sizeof(changes)));
+  EXPECT_EQ(2u, changes);
+  EXPECT_EQ(0, poll(&pfd, 1u, 0));
+#else
+  EXPECT_EQ(-1, fd);
+#endif
+}
+
+TEST(test_graph_cache, churn)
+{
+  GraphCache graph_cache;
+  add_participants(graph_cache, {"participant1"});
+  EXPECT_TRUE(graph_cache.get_top_churn_topics(10u).empty());
+  EXPECT_TRUE(graph_cache.get_top_churn_participants(10u).empty());
+
+  const std::chrono::hours bucket_period{1};
+  graph_cache.set_churn_window({bucket_period, 3u});
+  const auto start = std::chrono::steady_clock::now();
+  add_participants(graph_cache, {"participant2"});
+  add_entities(
+    graph_cache,
+    {
+      {"reader1", "participant1", "topic1", "Str", true},
+      {"writer1", "participant1", "topic1", "Str", false},
+      {"writer2", "participant2", "topic2", "Str", false},
+    });
+  EXPECT_TRUE(graph_cache.remove_writer(gid_from_string("writer1")));
+  EXPECT_TRUE(graph_cache.remove_reader(gid_from_string("reader1")));
+  // Not churn.
+  EXPECT_FALSE(graph_cache.remove_reader(gid_from_string("reader1")));
+
+  auto topics = graph_cache.get_top_churn_topics(10u, start);
+  ASSERT_EQ(2u, topics.size());
+  EXPECT_EQ("topic1", topics[0].topic_name);
+  EXPECT_EQ(2u, topics[0].added);
+  EXPECT_EQ(2u, topics[0].removed);
+  EXPECT_EQ("topic2", topics[1].topic_name);
+  EXPECT_EQ(1u, topics[1].added);
+  EXPECT_EQ(0u, topics[1].removed);
+  EXPECT_EQ(1u, graph_cache.get_top_churn_topics(1u, start).size());
+
+  auto participants = graph_cache.get_top_churn_participants(10u, start);
+  ASSERT_EQ(2u, participants.size());
+  EXPECT_EQ(gid_from_string("participant1"), participants[0].participant_gid);
+  EXPECT_EQ(2u, participants[0].added);
+  EXPECT_EQ(2u, participants[0].removed);
+  EXPECT_EQ(gid_from_string("participant2"), participants[1].participant_gid);
+  EXPECT_EQ(2u, participants[1].added);
+  EXPECT_EQ(0u, participants[1].removed);
+
+  // Counts leave the window with their bucket.
+  EXPECT_EQ(2u, graph_cache.get_top_churn_topics(10u, start + 2 * bucket_period).size());
+  EXPECT_TRUE(graph_cache.get_top_churn_topics(10u, start + 3 * bucket_period).empty());
+  EXPECT_TRUE(graph_cache.get_top_churn_participants(10u, start + 3 * bucket_period).empty());
+
+  // Removals held back are counted once, and so are additions folded into them.
+  graph_cache.set_churn_window({bucket_period, 3u});
+  graph_cache.set_removal_hysteresis(std::chrono::seconds(10));
+  EXPECT_TRUE(graph_cache.remove_writer(gid_from_string("writer2")));
+  EXPECT_FALSE(graph_cache.remove_writer(gid_from_string("writer2")));
+  add_entities(graph_cache, {{"writer2", "participant2", "topic2", "Str", false}});
+  topics = graph_cache.get_top_churn_topics(10u, std::chrono::steady_clock::now());
+  ASSERT_EQ(1u, topics.size());
+  EXPECT_EQ(1u, topics[0].added);
+  EXPECT_EQ(1u, topics[0].removed);
+}
+
+TEST(test_graph_cache, change_index)
+{
+  using GraphChange = GraphCache::GraphChange;
+  GraphCache graph_cache;
+  add_participants(graph_cache, {"participant1"});
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg({"participant1", {{"ns1", "node1", {"reader1"}, {}}}}));
+  add_entities(graph_cache, {{"reader1", "participant1", "topic1", "Str", true}});
+  EXPECT_TRUE(graph_cache.get_changes_since(0u).truncated);
+
+  graph_cache.set_change_index_config({true, 2u});
+  const uint64_t generation = graph_cache.get_graph_generation();
+  const auto time = std::chrono::steady_clock::now();
+  // Changes made before the index was enabled are not known.
+  EXPECT_TRUE(graph_cache.get_changes_since(generation - 1u).truncated);
+  auto changes = graph_cache.get_changes_since(generation);
+  EXPECT_FALSE(changes.truncated);
+  EXPECT_TRUE(changes.changes.empty());
+  EXPECT_EQ(generation, changes.generation);
+
+  add_entities(graph_cache, {{"writer1", "participant1", "topic2", "Str", false}});
+  graph_cache.update_participant_entities(
+    get_participant_entities_info_msg(
+      {"participant1", {{"ns1", "node1", {"reader1"}, {}}, {"ns2", "node2", {}, {}}}}));
+  EXPECT_TRUE(graph_cache.remove_reader(gid_from_string("reader1")));
+  changes = graph_cache.get_changes_since(generation);
+  EXPECT_FALSE(changes.truncated);
+  EXPECT_EQ(generation + 3u, changes.generation);
+  ASSERT_EQ(3u, changes.changes.size());
+  EXPECT_EQ(GraphChange::Kind::data_writer, changes.changes[0].kind);
+  EXPECT_FALSE(changes.changes[0].removed);
+  EXPECT_EQ(gid_from_string("writer1"), changes.changes[0].gid);
+  EXPECT_EQ("topic2", changes.changes[0].topic_name);
+  EXPECT_EQ(generation + 1u, changes.changes[0].stamp.generation);
+  EXPECT_EQ(GraphChange::Kind::node, changes.changes[1].kind);
+  EXPECT_FALSE(changes.changes[1].removed);
+  EXPECT_EQ(gid_from_string("participant1"), changes.changes[1].gid);
+  EXPECT_EQ("ns2", changes.changes[1].node_namespace);
+  EXPECT_EQ("node2", changes.changes[1].node_name);
+  EXPECT_EQ(GraphChange::Kind::data_reader, changes.changes[2].kind);
+  EXPECT_TRUE(changes.changes[2].removed);
+  EXPECT_EQ("topic1", changes.changes[2].topic_name);
+  EXPECT_EQ(3u, graph_cache.get_changes_since(time).changes.size());
+  EXPECT_TRUE(graph_cache.get_changes_since(changes.generation).changes.empty());
+
+  // Only the last change of an entry is kept.
+  graph_cache.update_node_entities(
+    [] {
+      rmw_dds_common::msg::ParticipantNodeEntitiesInfo msg;
+      msg.gid = gid_msg_from_string("participant1");
+      msg.node_namespace = "ns2";
+      msg.node_name = "node2";
+      msg.writer_gid_seq.push_back(gid_msg_from_string("writer1"));
+      return msg;
+    }());
+  changes = graph_cache.get_changes_since(generation);
+  ASSERT_EQ(3u, changes.changes.size());
+  EXPECT_EQ(GraphChange::Kind::data_writer, changes.changes[0].kind);
+  EXPECT_EQ(GraphChange::Kind::data_reader, changes.changes[1].kind);
+  EXPECT_EQ(GraphChange::Kind::node, changes.changes[2].kind);
+  EXPECT_EQ(generation + 4u, changes.changes[2].stamp.generation);
+
+  // Removing a participant removes its nodes, the oldest removals are dropped.
+  EXPECT_TRUE(graph_cache.remove_participant(gid_from_string("participant1")));
+  changes = graph_cache.get_changes_since(generation);
+  EXPECT_TRUE(changes.truncated);
+  ASSERT_EQ(3u, changes.changes.size());
+  EXPECT_EQ(GraphChange::Kind::data_writer, changes.changes[0].kind);
+  EXPECT_EQ(GraphChange::Kind::node, changes.changes[1].kind);
+  EXPECT_TRUE(changes.changes[1].removed);
+  EXPECT_EQ(GraphChange::Kind::node, changes.changes[2].kind);
+  EXPECT_TRUE(changes.changes[2].removed);
+  EXPECT_FALSE(graph_cache.get_changes_since(generation + 4u).truncated);
+
+  // Folding a held removal into a new gid is a single change of both gids.
+  graph_cache.set_removal_hysteresis(std::chrono::hours(1));
+  add_entities(graph_cache, {{"writer2", "participant2", "topic3", "Str", false}});
+  remove_entities(graph_cache, {{"writer2", "participant2", "topic3", "Str", false}});
+  const uint64_t fold_generation = graph_cache.get_graph_generation();
+  add_entities(graph_cache, {{"writer2_new", "participant2", "topic3", "Str", false}});
+  changes = graph_cache.get_changes_since(fold_generation);
+  EXPECT_EQ(fold_generation + 1u, changes.generation);
+  ASSERT_EQ(2u, changes.changes.size());
+  EXPECT_TRUE(changes.changes[0].removed);
+  EXPECT_EQ(gid_from_string("writer2"), changes.changes[0].gid);
+  EXPECT_EQ(fold_generation + 1u, changes.changes[0].stamp.generation);
+  EXPECT_FALSE(changes.changes[1].removed);
+  EXPECT_EQ(gid_from_string("writer2_new"), changes.changes[1].gid);
+  EXPECT_EQ(fold_generation + 1u, changes.changes[1].stamp.generation);
+
+  // Folding into the same gid is only a change if the participant changed.
+  remove_entities(graph_cache, {{"writer2_new", "participant2", "topic3", "Str", false}});
+  add_entities(graph_cache, {{"writer2_new", "participant2", "topic3", "Str", false}});
+  EXPECT_EQ(fold_generation + 1u, graph_cache.get_graph_generation());
+  EXPECT_TRUE(graph_cache.get_changes_since(fold_generation + 1u).changes.empty());
+  remove_entities(graph_cache, {{"writer2_new", "participant2", "topic3", "Str", false}});
+  add_entities(graph_cache, {{"writer2_new", "participant3", "topic3", "Str", false}});
+  changes = graph_cache.get_changes_since(fold_generation + 1u);
+  EXPECT_EQ(fold_generation + 2u, changes.generation);
+  ASSERT_EQ(1u, changes.changes.size());
+  EXPECT_FALSE(changes.changes[0].removed);
+  EXPECT_EQ(gid_from_string("writer2_new"), changes.changes[0].gid);
+  EXPECT_EQ(fold_generation + 2u, changes.changes[0].stamp.generation);
+  EXPECT_TRUE(graph_cache.get_changes_since(changes.generation).changes.empty());
+
+  graph_cache.set_change_index_config({false, 2u});
+  changes = graph_cache.get_changes_since(generation);
+  EXPECT_TRUE(changes.truncated);
+  EXPECT_TRUE(changes.changes.empty());
+}
+
+TEST(test_graph_cache, resolve_best_available_qos)
+{
+  GraphCache graph_cache;
+  add_participants(graph_cache, {"participant1"});
+  rmw_qos_profile_t reliable_qos = rmw_qos_profile_default;
+  reliable_qos.deadline = {1, 0};
+  rmw_qos_profile_t best_effort_qos = rmw_qos_profile_sensor_data;
+  best_effort_qos.liveliness = RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC;
+  best_effort_qos.deadline = {2, 0};
+  auto add_entity = [&graph_cache](
+    const std::string & gid, const std::string & topic_name,
+    const rmw_qos_profile_t & qos, bool is_reader)
+    {
+      EXPECT_TRUE(
+        graph_cache.add_entity(
+          gid_from_string(gid), topic_name, "Str", rosidl_get_zero_initialized_type_hash(),
+          gid_from_string("participant1"), qos, is_reader));
+    };
+  add_entity("writer1", "topic1", reliable_qos, false);
+  add_entity("writer2", "topic1", best_effort_qos, false);
+  add_entity("writer3", "topic2", reliable_qos, false);
+  add_entity("reader1", "topic1", reliable_qos, true);
+  add_entity("reader2", "topic1", best_effort_qos, true);
+
+  rmw_qos_profile_t keep_all_qos = rmw_qos_profile_default;
+  keep_all_qos.history = RMW_QOS_POLICY_HISTORY_KEEP_ALL;
+  keep_all_qos.reliability = RMW_QOS_POLICY_RELIABILITY_BEST_AVAILABLE;
+  std::vector<GraphCache::BestAvailableQosRequest> requests;
+  for (const char * topic_name : {"topic1", "topic2", "topic3"}) {
+    requests.push_back({topic_name, true, rmw_qos_profile_best_available});
+    requests.push_back({topic_name, false, rmw_qos_profile_best_available});
+  }
+  requests.push_back({"topic1", true, keep_all_qos});
+  requests.push_back({"topic1", false, rmw_qos_profile_default});
+  const auto original_requests = requests;
+  graph_cache.resolve_best_available_qos(requests);
+
+  // Same results as resolving each profile from the topic endpoints info.
+  rcutils_allocator_t allocator = rcutils_get_default_allocator();
+  for (size_t i = 0u; i < requests.size(); i++) {
+    const auto & request = requests[i];
+    rmw_qos_profile_t expected = original_requests[i].qos;
+    rmw_topic_endpoint_info_array_t info = rmw_get_zero_initialized_topic_endpoint_info_array();
+    if (request.is_reader) {
+      ASSERT_EQ(
+        RMW_RET_OK,
+        graph_cache.get_writers_info_by_topic(
+          request.topic_name, identity_demangle, &allocator, &info));
+      EXPECT_EQ(
+        RMW_RET_OK,
+        rmw_dds_common::qos_profile_get_best_available_for_subscription(&info, &expected));
+    } else {
+      ASSERT_EQ(
+        RMW_RET_OK,
+        graph_cache.get_readers_info_by_topic(
+          request.topic_name, identity_demangle, &allocator, &info));
+      EXPECT_EQ(
+        RMW_RET_OK,
+        rmw_dds_common::qos_profile_get_best_available_for_publisher(&info, &expected));
+    }
+    EXPECT_EQ(RMW_RET_OK, rmw_topic_endpoint_info_array_fini(&info, &allocator));
+    EXPECT_EQ(expected.history, request.qos.history) << i;
+    EXPECT_EQ(expected.reliability, request.qos.reliability) << i;
+    EXPECT_EQ(expected.durability, request.qos.durability) << i;
+    EXPECT_EQ(expected.liveliness, request.qos.liveliness) << i;
+    EXPECT_EQ(expected.deadline.sec, request.qos.deadline.sec) << i;
+    EXPECT_EQ(expected.deadline.nsec, request.qos.deadline.nsec) << i;
+    EXPECT_EQ(
+      expected.liveliness_lease_duration.sec, request.qos.liveliness_lease_duration.sec) << i;
+  }
+  EXPECT_EQ(RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT, requests[0].qos.reliability);
+  EXPECT_EQ(2u, requests[0].qos.deadline.sec);
+  EXPECT_EQ(1u, requests[1].qos.deadline.sec);
+  EXPECT_EQ(RMW_QOS_POLICY_RELIABILITY_RELIABLE, requests[2].qos.reliability);
+  EXPECT_EQ(RMW_QOS_POLICY_HISTORY_KEEP_ALL, requests[6].qos.history);
+  EXPECT_EQ(RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT, requests[6].qos.reliability);
+}
+
 TEST(test_graph_cache, test_operator)
 {
   GraphCache graph_cache;
@@ -15,6 +15,7 @@
 #include <gtest/gtest.h>
 
 #include <cstring>
+#include <vector>
 
 #include "osrf_testing_tools_cpp/scope_exit.hpp"
 #include "rcpputils/scope_exit.hpp"
@@ -1074,6 +1075,141 @@ TEST(test_qos, test_qos_profile_update_best_available_for_services)
       output_profile.liveliness_lease_duration));
 }
 
+TEST(test_qos, test_qos_profile_services_default_policies)
+{
+  const rmw_qos_profile_t & policies = rmw_dds_common::qos_profile_services_default_policies;
+  EXPECT_EQ(rmw_qos_profile_services_default.history, policies.history);
+  EXPECT_EQ(rmw_qos_profile_services_default.depth, policies.depth);
+  EXPECT_EQ(rmw_qos_profile_services_default.reliability, policies.reliability);
+  EXPECT_EQ(rmw_qos_profile_services_default.durability, policies.durability);
+  EXPECT_TRUE(rmw_time_equal(rmw_qos_profile_services_default.deadline, policies.deadline));
+  EXPECT_TRUE(rmw_time_equal(rmw_qos_profile_services_default.lifespan, policies.lifespan));
+  EXPECT_EQ(rmw_qos_profile_services_default.liveliness, policies.liveliness);
+  EXPECT_TRUE(
+    rmw_time_equal(
+      rmw_qos_profile_services_default.liveliness_lease_duration,
+      policies.liveliness_lease_duration));
+  EXPECT_EQ(
+    rmw_qos_profile_services_default.avoid_ros_namespace_conventions,
+    policies.avoid_ros_namespace_conventions);
+}
+
+TEST(test_qos, test_qos_profile_constexpr)
+{
+  constexpr rmw_qos_profile_t reliable = {
+    RMW_QOS_POLICY_HISTORY_KEEP_LAST,
+    5,
+    RMW_QOS_POLICY_RELIABILITY_RELIABLE,
+    RMW_QOS_POLICY_DURABILITY_VOLATILE,
+    RMW_QOS_DEADLINE_DEFAULT,
+    RMW_QOS_LIFESPAN_DEFAULT,
+    RMW_QOS_POLICY_LIVELINESS_AUTOMATIC,
+    RMW_QOS_LIVELINESS_LEASE_DURATION_DEFAULT,
+    false
+  };
+  constexpr rmw_qos_profile_t best_effort = {
+    RMW_QOS_POLICY_HISTORY_KEEP_LAST,
+    5,
+    RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT,
+    RMW_QOS_POLICY_DURABILITY_VOLATILE,
+    {1, 0},
+    RMW_QOS_LIFESPAN_DEFAULT,
+    RMW_QOS_POLICY_LIVELINESS_SYSTEM_DEFAULT,
+    RMW_QOS_LIVELINESS_LEASE_DURATION_DEFAULT,
+    false
+  };
+  static_assert(
+    RMW_QOS_COMPATIBILITY_OK == rmw_dds_common::qos_profile_get_compatibility(reliable, reliable));
+  static_assert(
+    rmw_dds_common::QOS_ERROR_RELIABILITY ==
+    rmw_dds_common::qos_profile_get_incompatibilities(best_effort, reliable));
+  static_assert(
+    rmw_dds_common::QOS_ERROR_DEADLINE_MISSING ==
+    rmw_dds_common::qos_profile_get_incompatibilities(reliable, best_effort));
+  static_assert(
+    rmw_dds_common::QOS_WARNING_LIVELINESS_UNKNOWN ==
+    rmw_dds_common::qos_profile_get_incompatibilities(best_effort, best_effort));
+
+  // Precomputed table.
+  constexpr rmw_qos_compatibility_type_t table[2][2] = {
+    {
+      rmw_dds_common::qos_profile_get_compatibility(reliable, reliable),
+      rmw_dds_common::qos_profile_get_compatibility(reliable, best_effort),
+    },
+    {
+      rmw_dds_common::qos_profile_get_compatibility(best_effort, reliable),
+      rmw_dds_common::qos_profile_get_compatibility(best_effort, best_effort),
+    },
+  };
+  static_assert(RMW_QOS_COMPATIBILITY_ERROR == table[0][1]);
+  static_assert(RMW_QOS_COMPATIBILITY_ERROR == table[1][0]);
+  static_assert(RMW_QOS_COMPATIBILITY_WARNING == table[1][1]);
+
+  constexpr rmw_qos_profile_t services =
+    rmw_dds_common::qos_profile_resolve_best_available_for_services(
+    {
+      RMW_QOS_POLICY_HISTORY_KEEP_LAST,
+      10,
+      RMW_QOS_POLICY_RELIABILITY_BEST_AVAILABLE,
+      RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL,
+      RMW_QOS_DEADLINE_BEST_AVAILABLE,
+      RMW_QOS_LIFESPAN_DEFAULT,
+      RMW_QOS_POLICY_LIVELINESS_BEST_AVAILABLE,
+      RMW_QOS_LIVELINESS_LEASE_DURATION_BEST_AVAILABLE,
+      false
+    });
+  static_assert(RMW_QOS_POLICY_RELIABILITY_RELIABLE == services.reliability);
+  static_assert(RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL == services.durability);
+  static_assert(RMW_QOS_POLICY_LIVELINESS_SYSTEM_DEFAULT == services.liveliness);
+  static_assert(0u == services.deadline.sec && 0u == services.deadline.nsec);
+}
+
+TEST(test_qos, test_qos_profile_get_compatibility_matches_runtime)
+{
+  const rmw_qos_reliability_policy_t reliabilities[] = {
+    RMW_QOS_POLICY_RELIABILITY_SYSTEM_DEFAULT,
+    RMW_QOS_POLICY_RELIABILITY_RELIABLE,
+    RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT,
+    RMW_QOS_POLICY_RELIABILITY_UNKNOWN,
+  };
+  const rmw_qos_durability_policy_t durabilities[] = {
+    RMW_QOS_POLICY_DURABILITY_SYSTEM_DEFAULT,
+    RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL,
+    RMW_QOS_POLICY_DURABILITY_VOLATILE,
+  };
+  const rmw_qos_liveliness_policy_t livelinesses[] = {
+    RMW_QOS_POLICY_LIVELINESS_SYSTEM_DEFAULT,
+    RMW_QOS_POLICY_LIVELINESS_AUTOMATIC,
+    RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC,
+  };
+  const rmw_time_t durations[] = {RMW_QOS_DEADLINE_DEFAULT, {1, 0}, {2, 0}};
+  std::vector<rmw_qos_profile_t> profiles;
+  for (auto reliability : reliabilities) {
+    for (auto durability : durabilities) {
+      for (auto liveliness : livelinesses) {
+        for (const auto & duration : durations) {
+          rmw_qos_profile_t profile = get_qos_profile_fixture();
+          profile.reliability = reliability;
+          profile.durability = durability;
+          profile.liveliness = liveliness;
+          profile.deadline = duration;
+          profile.liveliness_lease_duration = duration;
+          profiles.push_back(profile);
+        }
+      }
+    }
+  }
+  for (const auto & pub : profiles) {
+    for (const auto & sub : profiles) {
+      rmw_qos_compatibility_type_t compatibility;
+      ASSERT_EQ(
+        RMW_RET_OK,
+        rmw_dds_common::qos_profile_check_compatible(pub, sub, &compatibility, nullptr, 0u));
+      EXPECT_EQ(compatibility, rmw_dds_common::qos_profile_get_compatibility(pub, sub));
+    }
+  }
+}
+
 TEST(test_qos, test_parse_type_hash_from_user_data)
 {
   const auto zero_val = rosidl_get_zero_initialized_type_hash();
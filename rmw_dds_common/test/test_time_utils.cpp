@@ -15,14 +15,24 @@
 #include <gtest/gtest.h>
 #include <climits>
 
+#include "rmw/qos_profiles.h"
+
 #include "rmw_dds_common/time_utils.hpp"
 
+using rmw_dds_common::DDSDuration;
+
 static bool
 operator==(rmw_time_t t1, rmw_time_t t2)
 {
   return t1.sec == t2.sec && t1.nsec == t2.nsec;
 }
 
+static bool
+operator==(DDSDuration d1, DDSDuration d2)
+{
+  return d1.sec == d2.sec && d1.nanosec == d2.nanosec;
+}
+
 TEST(test_time_utils, test_unmodified_zeros)
 {
   const rmw_time_t zeros {0, 0};
@@ -94,3 +104,87 @@ TEST(test_time_utils, test_normalize)
   auto normalized_max_2 = rmw_dds_common::clamp_rmw_time_to_dds_time(unnormalized_max_2);
   EXPECT_TRUE(normalized_max_2 == normalized_max_expected);
 }
+
+TEST(test_time_utils, test_nanoseconds)
+{
+  const rmw_time_t infinite = RMW_DURATION_INFINITE;
+  EXPECT_EQ(LLONG_MAX, rmw_dds_common::rmw_time_to_nanoseconds(infinite));
+  EXPECT_TRUE(rmw_dds_common::nanoseconds_to_rmw_time(LLONG_MAX) == infinite);
+
+  const rmw_time_t unnormalized {1, 1500000000ULL};
+  EXPECT_EQ(2500000000LL, rmw_dds_common::rmw_time_to_nanoseconds(unnormalized));
+  const rmw_time_t normalized {2, 500000000ULL};
+  EXPECT_TRUE(rmw_dds_common::nanoseconds_to_rmw_time(2500000000LL) == normalized);
+
+  // Saturation.
+  const rmw_time_t max_64 {ULLONG_MAX, ULLONG_MAX};
+  EXPECT_EQ(LLONG_MAX, rmw_dds_common::rmw_time_to_nanoseconds(max_64));
+  const rmw_time_t max_sec_overflow {9223372036ULL, 854775808ULL};
+  EXPECT_EQ(LLONG_MAX, rmw_dds_common::rmw_time_to_nanoseconds(max_sec_overflow));
+  const rmw_time_t above_max_sec {9223372037ULL, 0};
+  EXPECT_EQ(LLONG_MAX, rmw_dds_common::rmw_time_to_nanoseconds(above_max_sec));
+  const rmw_time_t max_sec_64 {LLONG_MAX, 0};
+  EXPECT_EQ(LLONG_MAX, rmw_dds_common::rmw_time_to_nanoseconds(max_sec_64));
+  const rmw_time_t zeros {0, 0};
+  EXPECT_TRUE(rmw_dds_common::nanoseconds_to_rmw_time(-1) == zeros);
+}
+
+TEST(test_time_utils, test_dds_duration)
+{
+  const DDSDuration zero {0, 0u};
+  const DDSDuration max_dds_duration {0x7FFFFFFF, 999999999u};
+  const rmw_time_t infinite = RMW_DURATION_INFINITE;
+  EXPECT_TRUE(
+    rmw_dds_common::rmw_time_to_dds_duration(infinite) == rmw_dds_common::dds_duration_infinite);
+  EXPECT_TRUE(
+    rmw_dds_common::dds_duration_to_rmw_time(rmw_dds_common::dds_duration_infinite) == infinite);
+
+  // Finite durations saturate like clamp_rmw_time_to_dds_time() does.
+  for (const rmw_time_t & time : {
+      rmw_time_t{0, 0}, rmw_time_t{1, 999999999ULL}, rmw_time_t{0, 1000000000ULL},
+      rmw_time_t{0x7FFFFFFE, 1999999999ULL}, rmw_time_t{0x80000000, 0},
+      rmw_time_t{9223372036ULL, 854775808ULL}, rmw_time_t{LLONG_MAX, 0},
+      rmw_time_t{ULLONG_MAX, ULLONG_MAX}})
+  {
+    const rmw_time_t clamped = rmw_dds_common::clamp_rmw_time_to_dds_time(time);
+    const DDSDuration duration = rmw_dds_common::rmw_time_to_dds_duration(time);
+    EXPECT_EQ(clamped.sec, static_cast<uint64_t>(duration.sec));
+    EXPECT_EQ(clamped.nsec, duration.nanosec);
+  }
+  EXPECT_TRUE(rmw_dds_common::nanoseconds_to_dds_duration(LLONG_MAX - 1) == max_dds_duration);
+  EXPECT_TRUE(rmw_dds_common::nanoseconds_to_dds_duration(-1) == zero);
+
+  const DDSDuration unnormalized {1, 1500000000u};
+  EXPECT_EQ(2500000000LL, rmw_dds_common::dds_duration_to_nanoseconds(unnormalized));
+  const DDSDuration negative {-1, 0u};
+  EXPECT_EQ(0, rmw_dds_common::dds_duration_to_nanoseconds(negative));
+}
+
+TEST(test_time_utils, test_qos_profile_durations)
+{
+  // Usable with compile time profiles.
+  constexpr rmw_qos_profile_t qos = {
+    RMW_QOS_POLICY_HISTORY_KEEP_LAST,
+    10,
+    RMW_QOS_POLICY_RELIABILITY_RELIABLE,
+    RMW_QOS_POLICY_DURABILITY_VOLATILE,
+    {1, 500000000ULL},
+    RMW_DURATION_INFINITE,
+    RMW_QOS_POLICY_LIVELINESS_AUTOMATIC,
+    {0x80000000, 0},
+    false
+  };
+  constexpr auto durations = rmw_dds_common::qos_profile_to_dds_durations(qos);
+  static_assert(1 == durations.deadline.sec && 500000000u == durations.deadline.nanosec);
+  static_assert(0x7FFFFFFF == durations.lifespan.sec && 0xFFFFFFFFu == durations.lifespan.nanosec);
+  static_assert(0x7FFFFFFF == durations.liveliness_lease_duration.sec);
+  static_assert(999999999u == durations.liveliness_lease_duration.nanosec);
+
+  const rmw_qos_profile_t converted =
+    rmw_dds_common::qos_profile_from_dds_durations(rmw_qos_profile_default, durations);
+  EXPECT_TRUE(converted.deadline == qos.deadline);
+  EXPECT_TRUE(converted.lifespan == qos.lifespan);
+  const rmw_time_t max_dds_time {0x7FFFFFFF, 999999999ULL};
+  EXPECT_TRUE(converted.liveliness_lease_duration == max_dds_time);
+  EXPECT_EQ(rmw_qos_profile_default.depth, converted.depth);
+}